@@ -22,9 +22,7 @@
 
 #include "custom-schedule-face.h"
 
-#define ALLOW_MANAGING_RULES
-#include "database-connection/database-connection.h"
-#undef ALLOW_MANAGING_RULES
+#include "gawake-configuration.h"
 
 #include "time-chooser.h"
 #include "mode-row.h"
@@ -123,6 +121,33 @@ custom_schedule_face_action_button_clicked (GtkButton *button,
   g_date_time_unref (datetime);
 }
 
+// The mode row follows the default mode, also when it's changed on the preferences
+static void
+custom_schedule_face_bind_default_mode (CustomScheduleFace  *self,
+                                        GawakeConfiguration *configuration)
+{
+  if (gawake_configuration_get_failed (configuration) & DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE)
+    return;
+
+  g_object_bind_property (configuration, "default-mode",
+                          self->mode_row, "selected",
+                          G_BINDING_SYNC_CREATE);
+}
+
+static void
+custom_schedule_face_configuration_loaded (GObject    *object,
+                                           GParamSpec *pspec,
+                                           gpointer    user_data)
+{
+  CustomScheduleFace *self = CUSTOM_SCHEDULE_FACE (user_data);
+
+  g_signal_handlers_disconnect_by_func (object,
+                                        custom_schedule_face_configuration_loaded,
+                                        self);
+
+  custom_schedule_face_bind_default_mode (self, GAWAKE_CONFIGURATION (object));
+}
+
 static void
 custom_schedule_face_dispose (GObject *gobject)
 {
@@ -152,7 +177,7 @@ custom_schedule_face_class_init (CustomScheduleFaceClass *klass)
 static void
 custom_schedule_face_init (CustomScheduleFace *self)
 {
-  Mode default_mode;
+  GawakeConfiguration *configuration = NULL;
 
   // Ensure types of custom widgets
   g_type_ensure (TIME_TYPE_CHOOSER);
@@ -167,10 +192,21 @@ custom_schedule_face_init (CustomScheduleFace *self)
                     self);
 
   // TODO connect database before initializing template
-  if (configuration_get_default_mode (&default_mode) == EXIT_SUCCESS)
-    mode_row_set_mode (self->mode_row, default_mode);
-  else
-    {} // g_warning ("Failed to load default mode to CustomScheduleFace");
+  configuration = gawake_configuration_get_default ();
+
+  if (gawake_configuration_get_loaded (configuration))
+    {
+      custom_schedule_face_bind_default_mode (self, configuration);
+      return;
+    }
+
+  g_signal_connect_object (configuration,
+                           "notify::loaded",
+                           G_CALLBACK (custom_schedule_face_configuration_loaded),
+                           self,
+                           0);
+
+  gawake_configuration_load (configuration);
 }
 
 CustomScheduleFace *
@@ -0,0 +1,664 @@
+/* database-async.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Asynchronous wrappers around database-connection, so the UI never blocks
+ * on the database (e.g. when the daemon holds a lock on it, or the storage
+ * is slow).
+ *
+ * Each call runs the synchronous function on a worker thread and returns
+ * through a GTask; the usual <call> + <call>_finish pair. The source object
+ * is kept alive until the callback runs, but widgets should still cancel
+ * their pending operations on dispose, and check for G_IO_ERROR_CANCELLED
+ * before touching any state.
+ *
+ * database-connection uses a single connection, so the worker threads are
+ * serialized by a lock.
+ *
+ * Reads are retried a few times, with an exponential backoff, as they
+ * usually fail only while the daemon is writing (the database is busy).
+ * Writes are not retried, since they are not all idempotent.
+ */
+
+#include "database-async.h"
+#include "gawake-timing.h"
+
+#define READ_ATTEMPTS         4
+#define READ_RETRY_DELAY_MS   25    // doubled on each retry
+
+G_LOCK_DEFINE_STATIC (database);
+
+typedef struct
+{
+  Table                     table;
+  guint32                   rule_id;
+  bool                      active;
+  Rule                      rule;
+  Rule                     *rules;
+  guint32                   count;
+  DatabaseAsyncRuleAction   action;
+  DatabaseBatchAction       batch_action;
+  GArray                   *rule_ids;
+} RuleTaskData;
+
+typedef struct
+{
+  DatabaseConfiguration        configuration;
+  DatabaseConfigurationField   fields;
+} ConfigurationTaskData;
+
+static void
+rule_task_data_free (gpointer data)
+{
+  RuleTaskData *rule_task_data = data;
+
+  // Only set when the rules weren't taken by the _finish call
+  free (rule_task_data->rules);
+  g_clear_pointer (&rule_task_data->rule_ids, g_array_unref);
+  g_free (rule_task_data);
+}
+
+static void
+database_async_run (gpointer             source_object,
+                    gpointer             source_tag,
+                    gpointer             task_data,
+                    GDestroyNotify       task_data_destroy,
+                    GTaskThreadFunc      thread_func,
+                    GCancellable        *cancellable,
+                    GAsyncReadyCallback  callback,
+                    gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+
+  task = g_task_new (source_object, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, task_data, task_data_destroy);
+  g_task_run_in_thread (task, thread_func);
+}
+
+/*
+ * Waits before retrying a failed read; returns FALSE if there are no attempts
+ * left, or the task was cancelled meanwhile. Must be called without the lock.
+ */
+static gboolean
+database_async_retry_read (guint         attempt,
+                           GCancellable *cancellable)
+{
+  if (attempt + 1 >= READ_ATTEMPTS || g_cancellable_is_cancelled (cancellable))
+    return FALSE;
+
+  g_usleep ((READ_RETRY_DELAY_MS << attempt) * G_TIME_SPAN_MILLISECOND);
+
+  return !g_cancellable_is_cancelled (cancellable);
+}
+
+static void
+database_async_return_status (GTask       *task,
+                              gint         status,
+                              const gchar *error)
+{
+  if (status == EXIT_FAILURE)
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", error);
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+/*
+ * database-connection still takes 16-bit ids; a larger id would be narrowed
+ * to another rule, so the task fails instead
+ */
+static gboolean
+database_async_check_rule_id (GTask   *task,
+                              guint32  rule_id)
+{
+  if (rule_id <= G_MAXUINT16)
+    return TRUE;
+
+  g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                           "Rule id %u is out of range", rule_id);
+
+  return FALSE;
+}
+
+// GET ALL
+static void
+database_async_rule_get_all_thread (GTask        *task,
+                                    gpointer      source_object,
+                                    gpointer      task_data,
+                                    GCancellable *cancellable)
+{
+  RuleTaskData *data = task_data;
+  guint16 row_count = 0; // database-connection's width; widened from here on
+  gint64 start;
+  gint status;
+
+  for (guint attempt = 0; ; attempt++)
+    {
+      G_LOCK (database);
+      start = gawake_timing_now ();
+      status = rule_get_all (data->table, &data->rules, &row_count);
+      G_UNLOCK (database);
+
+      gawake_timing_record ("rule_get_all", start, row_count);
+
+      if (status != EXIT_FAILURE || !database_async_retry_read (attempt, cancellable))
+        break;
+    }
+
+  data->count = row_count;
+
+  database_async_return_status (task, status, "Failed to get rules");
+}
+
+void
+database_async_rule_get_all (gpointer             source_object,
+                             Table                table,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+  RuleTaskData *data = g_new0 (RuleTaskData, 1);
+
+  data->table = table;
+
+  database_async_run (source_object, database_async_rule_get_all,
+                      data, rule_task_data_free,
+                      database_async_rule_get_all_thread,
+                      cancellable, callback, user_data);
+}
+
+/*
+ * On success, <rules> must be released with free (), as the ones returned
+ * by rule_get_all
+ */
+gboolean
+database_async_rule_get_all_finish (GAsyncResult  *result,
+                                    Rule         **rules,
+                                    guint32       *count,
+                                    GError       **error)
+{
+  RuleTaskData *data = NULL;
+
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  data = g_task_get_task_data (G_TASK (result));
+  *rules = g_steal_pointer (&data->rules);
+  *count = data->count;
+
+  return TRUE;
+}
+
+// GET SINGLE
+static void
+database_async_rule_get_single_thread (GTask        *task,
+                                       gpointer      source_object,
+                                       gpointer      task_data,
+                                       GCancellable *cancellable)
+{
+  RuleTaskData *data = task_data;
+  gint64 start;
+  gint status;
+
+  if (!database_async_check_rule_id (task, data->rule_id))
+    return;
+
+  for (guint attempt = 0; ; attempt++)
+    {
+      G_LOCK (database);
+      start = gawake_timing_now ();
+      status = rule_get_single (data->rule_id, data->table, &data->rule);
+      G_UNLOCK (database);
+
+      gawake_timing_record ("rule_get_single", start, 1);
+
+      if (status != EXIT_FAILURE || !database_async_retry_read (attempt, cancellable))
+        break;
+    }
+
+  database_async_return_status (task, status, "Failed to get rule");
+}
+
+void
+database_async_rule_get_single (gpointer             source_object,
+                                guint32              rule_id,
+                                Table                table,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  RuleTaskData *data = g_new0 (RuleTaskData, 1);
+
+  data->rule_id = rule_id;
+  data->table = table;
+
+  database_async_run (source_object, database_async_rule_get_single,
+                      data, rule_task_data_free,
+                      database_async_rule_get_single_thread,
+                      cancellable, callback, user_data);
+}
+
+gboolean
+database_async_rule_get_single_finish (GAsyncResult  *result,
+                                       Rule          *rule,
+                                       GError       **error)
+{
+  RuleTaskData *data = NULL;
+
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  data = g_task_get_task_data (G_TASK (result));
+  *rule = data->rule;
+
+  return TRUE;
+}
+
+// ENABLE/DISABLE
+static void
+database_async_rule_enable_disable_thread (GTask        *task,
+                                           gpointer      source_object,
+                                           gpointer      task_data,
+                                           GCancellable *cancellable)
+{
+  RuleTaskData *data = task_data;
+  gint64 start;
+  gint status;
+
+  if (!database_async_check_rule_id (task, data->rule_id))
+    return;
+
+  G_LOCK (database);
+  start = gawake_timing_now ();
+  status = rule_enable_disable (data->rule_id, data->table, data->active);
+  G_UNLOCK (database);
+
+  gawake_timing_record ("rule_enable_disable", start, 1);
+
+  database_async_return_status (task, status, "Failed to change rule state");
+}
+
+void
+database_async_rule_enable_disable (gpointer             source_object,
+                                    guint32              rule_id,
+                                    Table                table,
+                                    bool                 active,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  RuleTaskData *data = g_new0 (RuleTaskData, 1);
+
+  data->rule_id = rule_id;
+  data->table = table;
+  data->active = active;
+
+  database_async_run (source_object, database_async_rule_enable_disable,
+                      data, rule_task_data_free,
+                      database_async_rule_enable_disable_thread,
+                      cancellable, callback, user_data);
+}
+
+gboolean
+database_async_rule_enable_disable_finish (GAsyncResult  *result,
+                                           GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+// DELETE
+static void
+database_async_rule_delete_thread (GTask        *task,
+                                   gpointer      source_object,
+                                   gpointer      task_data,
+                                   GCancellable *cancellable)
+{
+  RuleTaskData *data = task_data;
+  gint64 start;
+  gint status;
+
+  if (!database_async_check_rule_id (task, data->rule_id))
+    return;
+
+  G_LOCK (database);
+  start = gawake_timing_now ();
+  status = rule_delete (data->rule_id, data->table);
+  G_UNLOCK (database);
+
+  gawake_timing_record ("rule_delete", start, 1);
+
+  database_async_return_status (task, status, "Failed to delete rule");
+}
+
+void
+database_async_rule_delete (gpointer             source_object,
+                            guint32              rule_id,
+                            Table                table,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+  RuleTaskData *data = g_new0 (RuleTaskData, 1);
+
+  data->rule_id = rule_id;
+  data->table = table;
+
+  database_async_run (source_object, database_async_rule_delete,
+                      data, rule_task_data_free,
+                      database_async_rule_delete_thread,
+                      cancellable, callback, user_data);
+}
+
+gboolean
+database_async_rule_delete_finish (GAsyncResult  *result,
+                                   GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+// BATCH (enable, disable, delete)
+static void
+database_async_rule_batch_thread (GTask        *task,
+                                  gpointer      source_object,
+                                  gpointer      task_data,
+                                  GCancellable *cancellable)
+{
+  RuleTaskData *data = task_data;
+  guint failed = 0;
+  gint64 start;
+
+  // The whole set is applied under one lock hold
+  G_LOCK (database);
+  start = gawake_timing_now ();
+
+  for (guint i = 0; i < data->rule_ids->len; i++)
+    {
+      guint32 rule_id = g_array_index (data->rule_ids, guint32, i);
+      gint status;
+
+      // Out of database-connection's range (see database_async_check_rule_id ())
+      if (rule_id > G_MAXUINT16)
+        {
+          failed++;
+          continue;
+        }
+
+      if (data->batch_action == DATABASE_BATCH_ACTION_DELETE)
+        status = rule_delete (rule_id, data->table);
+      else
+        status = rule_enable_disable (rule_id,
+                                      data->table,
+                                      data->batch_action == DATABASE_BATCH_ACTION_ENABLE);
+
+      if (status == EXIT_FAILURE)
+        failed++;
+    }
+
+  G_UNLOCK (database);
+
+  gawake_timing_record ("rule_batch", start, data->rule_ids->len);
+
+  if (failed > 0)
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             "Failed on %u of %u rules", failed, data->rule_ids->len);
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+// <rule_ids> is an array of guint32; it is referenced, and must not be changed
+void
+database_async_rule_batch (gpointer             source_object,
+                           DatabaseBatchAction  action,
+                           Table                table,
+                           GArray              *rule_ids,
+                           GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+  RuleTaskData *data = g_new0 (RuleTaskData, 1);
+
+  data->batch_action = action;
+  data->table = table;
+  data->rule_ids = g_array_ref (rule_ids);
+
+  database_async_run (source_object, database_async_rule_batch,
+                      data, rule_task_data_free,
+                      database_async_rule_batch_thread,
+                      cancellable, callback, user_data);
+}
+
+gboolean
+database_async_rule_batch_finish (GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+// ACTION (add, edit)
+static void
+database_async_rule_action_thread (GTask        *task,
+                                   gpointer      source_object,
+                                   gpointer      task_data,
+                                   GCancellable *cancellable)
+{
+  RuleTaskData *data = task_data;
+  gint64 start;
+  guint32 rule_id;
+
+  G_LOCK (database);
+  start = gawake_timing_now ();
+  rule_id = data->action (&data->rule);
+  G_UNLOCK (database);
+
+  gawake_timing_record ("rule_action", start, 1);
+
+  if (rule_id == 0)
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "Operation failed");
+  else
+    g_task_return_int (task, rule_id);
+}
+
+void
+database_async_rule_action (gpointer                 source_object,
+                            DatabaseAsyncRuleAction  action,
+                            const Rule              *rule,
+                            GCancellable            *cancellable,
+                            GAsyncReadyCallback      callback,
+                            gpointer                 user_data)
+{
+  RuleTaskData *data = g_new0 (RuleTaskData, 1);
+
+  data->action = action;
+  data->rule = *rule;
+
+  database_async_run (source_object, database_async_rule_action,
+                      data, rule_task_data_free,
+                      database_async_rule_action_thread,
+                      cancellable, callback, user_data);
+}
+
+// Returns the rule id, or 0 on failure
+guint32
+database_async_rule_action_finish (GAsyncResult  *result,
+                                   GError       **error)
+{
+  gssize rule_id;
+
+  g_return_val_if_fail (g_task_is_valid (result, NULL), 0);
+
+  rule_id = g_task_propagate_int (G_TASK (result), error);
+
+  return (rule_id < 0) ? 0 : (guint32) rule_id;
+}
+
+// CONFIGURATION
+static void
+database_async_configuration_get_thread (GTask        *task,
+                                         gpointer      source_object,
+                                         gpointer      task_data,
+                                         GCancellable *cancellable)
+{
+  DatabaseConfiguration *configuration = &((ConfigurationTaskData *) task_data)->configuration;
+  gint64 start;
+
+  for (guint attempt = 0; ; attempt++)
+    {
+      configuration->failed = 0;
+
+      G_LOCK (database);
+      start = gawake_timing_now ();
+
+      if (configuration_get_shutdown_fail (&configuration->shutdown_fail))
+        configuration->failed |= DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL;
+
+      if (configuration_get_notification_time (&configuration->notification_time))
+        configuration->failed |= DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME;
+
+      if (configuration_get_default_mode (&configuration->default_mode))
+        configuration->failed |= DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE;
+
+      if (configuration_get_localtime (&configuration->use_localtime))
+        configuration->failed |= DATABASE_CONFIGURATION_FIELD_LOCALTIME;
+
+      G_UNLOCK (database);
+
+      gawake_timing_record ("configuration_get", start, -1);
+
+      if (configuration->failed == 0 || !database_async_retry_read (attempt, cancellable))
+        break;
+    }
+
+  // Partial failures are reported through <failed>
+  if (configuration->failed == DATABASE_CONFIGURATION_FIELD_ALL)
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to get configuration");
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+void
+database_async_configuration_get (gpointer             source_object,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  ConfigurationTaskData *data = g_new0 (ConfigurationTaskData, 1);
+
+  database_async_run (source_object, database_async_configuration_get,
+                      data, g_free,
+                      database_async_configuration_get_thread,
+                      cancellable, callback, user_data);
+}
+
+gboolean
+database_async_configuration_get_finish (GAsyncResult           *result,
+                                         DatabaseConfiguration  *configuration,
+                                         GError                **error)
+{
+  ConfigurationTaskData *data = NULL;
+
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  data = g_task_get_task_data (G_TASK (result));
+  *configuration = data->configuration;
+
+  return TRUE;
+}
+
+static void
+database_async_configuration_set_thread (GTask        *task,
+                                         gpointer      source_object,
+                                         gpointer      task_data,
+                                         GCancellable *cancellable)
+{
+  ConfigurationTaskData *data = task_data;
+  DatabaseConfiguration *configuration = &data->configuration;
+  gint64 start;
+
+  configuration->failed = 0;
+
+  G_LOCK (database);
+  start = gawake_timing_now ();
+
+  if ((data->fields & DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL)
+      && configuration_set_shutdown_fail (configuration->shutdown_fail) == EXIT_FAILURE)
+    configuration->failed |= DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL;
+
+  if ((data->fields & DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME)
+      && configuration_set_notification_time (configuration->notification_time) == EXIT_FAILURE)
+    configuration->failed |= DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME;
+
+  if ((data->fields & DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE)
+      && configuration_set_default_mode (configuration->default_mode) == EXIT_FAILURE)
+    configuration->failed |= DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE;
+
+  if ((data->fields & DATABASE_CONFIGURATION_FIELD_LOCALTIME)
+      && configuration_set_localtime (configuration->use_localtime) == EXIT_FAILURE)
+    configuration->failed |= DATABASE_CONFIGURATION_FIELD_LOCALTIME;
+
+  G_UNLOCK (database);
+
+  gawake_timing_record ("configuration_set", start, -1);
+
+  database_async_return_status (task,
+                                (configuration->failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE,
+                                "Failed to set configuration");
+}
+
+// Only the <fields> of <configuration> are written
+void
+database_async_configuration_set (gpointer                      source_object,
+                                  const DatabaseConfiguration  *configuration,
+                                  DatabaseConfigurationField    fields,
+                                  GCancellable                 *cancellable,
+                                  GAsyncReadyCallback           callback,
+                                  gpointer                      user_data)
+{
+  ConfigurationTaskData *data = g_new0 (ConfigurationTaskData, 1);
+
+  data->configuration = *configuration;
+  data->fields = fields;
+
+  database_async_run (source_object, database_async_configuration_set,
+                      data, g_free,
+                      database_async_configuration_set_thread,
+                      cancellable, callback, user_data);
+}
+
+gboolean
+database_async_configuration_set_finish (GAsyncResult  *result,
+                                         GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
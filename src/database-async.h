@@ -0,0 +1,144 @@
+/* database-async.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#define ALLOW_MANAGING_RULES
+#define ALLOW_MANAGING_CONFIGURATION
+# include "database-connection/database-connection.h"
+#undef ALLOW_MANAGING_CONFIGURATION
+#undef ALLOW_MANAGING_RULES
+
+G_BEGIN_DECLS
+
+/* Action performed on a rule by the worker thread (e.g. rule_add or rule_edit);
+ * it returns the rule id, or 0 on failure
+ */
+typedef guint32 (*DatabaseAsyncRuleAction) (Rule *rule);
+
+/* Set-based operations, applied to several rules in a single task */
+typedef enum
+{
+  DATABASE_BATCH_ACTION_ENABLE,
+  DATABASE_BATCH_ACTION_DISABLE,
+  DATABASE_BATCH_ACTION_DELETE
+} DatabaseBatchAction;
+
+typedef enum
+{
+  DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL     = 1 << 0,
+  DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME = 1 << 1,
+  DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE      = 1 << 2,
+  DATABASE_CONFIGURATION_FIELD_LOCALTIME         = 1 << 3,
+
+  DATABASE_CONFIGURATION_FIELD_ALL               = (1 << 4) - 1
+} DatabaseConfigurationField;
+
+typedef struct
+{
+  bool                          shutdown_fail;
+  gint                          notification_time;
+  Mode                          default_mode;
+  bool                          use_localtime;
+
+  /* Fields that could not be read or written */
+  DatabaseConfigurationField    failed;
+} DatabaseConfiguration;
+
+// RULES
+void database_async_rule_get_all (gpointer             source_object,
+                                  Table                table,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data);
+gboolean database_async_rule_get_all_finish (GAsyncResult  *result,
+                                             Rule         **rules,
+                                             guint32       *count,
+                                             GError       **error);
+
+void database_async_rule_get_single (gpointer             source_object,
+                                     guint32              rule_id,
+                                     Table                table,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data);
+gboolean database_async_rule_get_single_finish (GAsyncResult  *result,
+                                                Rule          *rule,
+                                                GError       **error);
+
+void database_async_rule_enable_disable (gpointer             source_object,
+                                         guint32              rule_id,
+                                         Table                table,
+                                         bool                 active,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             user_data);
+gboolean database_async_rule_enable_disable_finish (GAsyncResult  *result,
+                                                    GError       **error);
+
+void database_async_rule_delete (gpointer             source_object,
+                                 guint32              rule_id,
+                                 Table                table,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data);
+gboolean database_async_rule_delete_finish (GAsyncResult  *result,
+                                            GError       **error);
+
+void database_async_rule_batch (gpointer             source_object,
+                                DatabaseBatchAction  action,
+                                Table                table,
+                                GArray              *rule_ids,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data);
+gboolean database_async_rule_batch_finish (GAsyncResult  *result,
+                                           GError       **error);
+
+void database_async_rule_action (gpointer                 source_object,
+                                 DatabaseAsyncRuleAction  action,
+                                 const Rule              *rule,
+                                 GCancellable            *cancellable,
+                                 GAsyncReadyCallback      callback,
+                                 gpointer                 user_data);
+guint32 database_async_rule_action_finish (GAsyncResult  *result,
+                                           GError       **error);
+
+// CONFIGURATION
+void database_async_configuration_get (gpointer             source_object,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data);
+gboolean database_async_configuration_get_finish (GAsyncResult           *result,
+                                                  DatabaseConfiguration  *configuration,
+                                                  GError                **error);
+
+void database_async_configuration_set (gpointer                      source_object,
+                                       const DatabaseConfiguration  *configuration,
+                                       DatabaseConfigurationField    fields,
+                                       GCancellable                 *cancellable,
+                                       GAsyncReadyCallback           callback,
+                                       gpointer                      user_data);
+gboolean database_async_configuration_set_finish (GAsyncResult   *result,
+                                                  GError        **error);
+
+G_END_DECLS
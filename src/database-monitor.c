@@ -0,0 +1,253 @@
+/* database-monitor.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Watches the database directory (the SQLite file, its journal and WAL), so
+ * changes made by the daemon or another client are noticed.
+ *
+ * Writes come in bursts (a transaction touches several files, an import
+ * writes hundreds of rules), so the events are coalesced: "changed" is
+ * emitted once things settle for DEBOUNCE_MS, or at most every MAX_DELAY_MS
+ * while they keep coming.
+ */
+
+#include "database-monitor.h"
+
+#define DEBOUNCE_MS   250
+#define MAX_DELAY_MS  1000
+
+struct _DatabaseMonitor
+{
+  GObject               parent_instance;
+
+  // Instance variables
+  gchar                *directory;
+  GFileMonitor         *file_monitor;
+  guint                 debounce_source_id;
+  gint64                first_event_time;
+};
+
+// Properties
+enum
+{
+  PROP_DIRECTORY = 1,
+
+  N_PROPS
+};
+
+static GParamSpec *obj_properties[N_PROPS];
+
+// Signals
+enum
+{
+  SIGNAL_CHANGED,
+
+  N_SIGNALS
+};
+
+static guint obj_signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE (DatabaseMonitor, database_monitor, G_TYPE_OBJECT)
+
+static gboolean
+database_monitor_emit_changed (gpointer user_data)
+{
+  DatabaseMonitor *self = DATABASE_MONITOR (user_data);
+
+  self->debounce_source_id = 0;
+  self->first_event_time = 0;
+
+  g_signal_emit (self,
+                 obj_signals[SIGNAL_CHANGED],
+                 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+database_monitor_file_changed (GFileMonitor      *file_monitor,
+                               GFile             *file,
+                               GFile             *other_file,
+                               GFileMonitorEvent  event_type,
+                               gpointer           user_data)
+{
+  DatabaseMonitor *self = DATABASE_MONITOR (user_data);
+  gint64 now;
+
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CHANGED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_RENAMED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+      break;
+
+    case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+    case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
+    case G_FILE_MONITOR_EVENT_UNMOUNTED:
+    case G_FILE_MONITOR_EVENT_MOVED:
+    default:
+      return;
+    }
+
+  now = g_get_monotonic_time ();
+
+  if (self->first_event_time == 0)
+    self->first_event_time = now;
+
+  g_clear_handle_id (&self->debounce_source_id, g_source_remove);
+
+  // Don't let a continuous stream of writes postpone the notification forever
+  if ((now - self->first_event_time) / 1000 >= MAX_DELAY_MS)
+    {
+      database_monitor_emit_changed (self);
+      return;
+    }
+
+  self->debounce_source_id = g_timeout_add (DEBOUNCE_MS,
+                                            database_monitor_emit_changed,
+                                            self);
+}
+
+static void
+database_monitor_constructed (GObject *gobject)
+{
+  DatabaseMonitor *self = DATABASE_MONITOR (gobject);
+  g_autoptr (GFile) directory = NULL;
+  g_autoptr (GError) error = NULL;
+
+  G_OBJECT_CLASS (database_monitor_parent_class)->constructed (gobject);
+
+  directory = g_file_new_for_path (self->directory);
+  self->file_monitor = g_file_monitor_directory (directory,
+                                                 G_FILE_MONITOR_WATCH_MOVES,
+                                                 NULL,
+                                                 &error);
+
+  if (self->file_monitor == NULL)
+    {
+      g_warning ("Failed to monitor the database directory: %s", error->message);
+      return;
+    }
+
+  // The coalescing is done here
+  g_file_monitor_set_rate_limit (self->file_monitor, 0);
+
+  g_signal_connect (self->file_monitor,
+                    "changed",
+                    G_CALLBACK (database_monitor_file_changed),
+                    self);
+}
+
+static void
+database_monitor_set_property (GObject      *object,
+                               guint         property_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  DatabaseMonitor *self = DATABASE_MONITOR (object);
+
+  switch (property_id)
+    {
+    case PROP_DIRECTORY:
+      self->directory = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+database_monitor_dispose (GObject *gobject)
+{
+  DatabaseMonitor *self = DATABASE_MONITOR (gobject);
+
+  g_clear_handle_id (&self->debounce_source_id, g_source_remove);
+
+  if (self->file_monitor != NULL)
+    g_file_monitor_cancel (self->file_monitor);
+  g_clear_object (&self->file_monitor);
+
+  G_OBJECT_CLASS (database_monitor_parent_class)->dispose (gobject);
+}
+
+static void
+database_monitor_finalize (GObject *gobject)
+{
+  g_free (DATABASE_MONITOR (gobject)->directory);
+
+  G_OBJECT_CLASS (database_monitor_parent_class)->finalize (gobject);
+}
+
+static void
+database_monitor_class_init (DatabaseMonitorClass *klass)
+{
+  // Properties
+  obj_properties[PROP_DIRECTORY] =
+    g_param_spec_string ("directory",
+                         NULL, NULL,
+                         NULL,
+                         G_PARAM_CONSTRUCT_ONLY |
+                         G_PARAM_WRITABLE |
+                         G_PARAM_STATIC_NAME);
+
+  G_OBJECT_CLASS (klass)->set_property = database_monitor_set_property;
+  g_object_class_install_properties (G_OBJECT_CLASS (klass),
+                                     N_PROPS,
+                                     obj_properties);
+
+  // Signals
+  obj_signals[SIGNAL_CHANGED] =
+    g_signal_new ("changed",
+                  DATABASE_TYPE_MONITOR,
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE,            // no return value
+                  0);                     // 0 arguments
+
+  // Constructor
+  G_OBJECT_CLASS (klass)->constructed = database_monitor_constructed;
+
+  G_OBJECT_CLASS (klass)->dispose = database_monitor_dispose;
+  G_OBJECT_CLASS (klass)->finalize = database_monitor_finalize;
+}
+
+static void
+database_monitor_init (DatabaseMonitor *self)
+{
+  self->directory = NULL;
+  self->file_monitor = NULL;
+  self->debounce_source_id = 0;
+  self->first_event_time = 0;
+}
+
+DatabaseMonitor *
+database_monitor_new (const gchar *directory)
+{
+  return DATABASE_MONITOR (g_object_new (DATABASE_TYPE_MONITOR,
+                                         "directory", directory,
+                                         NULL));
+}
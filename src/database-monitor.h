@@ -0,0 +1,33 @@
+/* database-monitor.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define DATABASE_TYPE_MONITOR (database_monitor_get_type ())
+
+G_DECLARE_FINAL_TYPE (DatabaseMonitor, database_monitor, DATABASE, MONITOR, GObject)
+
+DatabaseMonitor *database_monitor_new (const gchar *directory);
+
+G_END_DECLS
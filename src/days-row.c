@@ -35,9 +35,11 @@ struct _DaysRow
   GtkToggleButton       *day_5;
   GtkToggleButton       *day_6;
 
-  guint16                rule_id;
+  guint32                rule_id;
   Table                  table;
   gboolean               interactive;
+  RuleDays               emitted_days;    // last days notified
+  guint                  tick_id;
 };
 
 // Properties
@@ -65,38 +67,74 @@ static guint obj_signals[N_SIGNALS];
 
 G_DEFINE_FINAL_TYPE (DaysRow, days_row, GTK_TYPE_BOX)
 
-void
-days_row_get_activated (DaysRow *self,
-                        bool    *days)
+RuleDays
+days_row_get_days (DaysRow *self)
 {
-  days[0] = gtk_toggle_button_get_active (self->day_0);
-  days[1] = gtk_toggle_button_get_active (self->day_1);
-  days[2] = gtk_toggle_button_get_active (self->day_2);
-  days[3] = gtk_toggle_button_get_active (self->day_3);
-  days[4] = gtk_toggle_button_get_active (self->day_4);
-  days[5] = gtk_toggle_button_get_active (self->day_5);
-  days[6] = gtk_toggle_button_get_active (self->day_6);
+  RuleDays days = RULE_DAYS_NONE;
+
+  days |= gtk_toggle_button_get_active (self->day_0) ? RULE_DAYS_DAY (0) : 0;
+  days |= gtk_toggle_button_get_active (self->day_1) ? RULE_DAYS_DAY (1) : 0;
+  days |= gtk_toggle_button_get_active (self->day_2) ? RULE_DAYS_DAY (2) : 0;
+  days |= gtk_toggle_button_get_active (self->day_3) ? RULE_DAYS_DAY (3) : 0;
+  days |= gtk_toggle_button_get_active (self->day_4) ? RULE_DAYS_DAY (4) : 0;
+  days |= gtk_toggle_button_get_active (self->day_5) ? RULE_DAYS_DAY (5) : 0;
+  days |= gtk_toggle_button_get_active (self->day_6) ? RULE_DAYS_DAY (6) : 0;
+
+  return days;
 }
 
-void
-days_row_set_activated (DaysRow *self, bool days[7])
+// Emits "value-updated" at most once per frame, and only on actual changes
+static gboolean
+days_row_value_updated_tick (GtkWidget     *widget,
+                             GdkFrameClock *frame_clock,
+                             gpointer       user_data)
+{
+  DaysRow *self = DAYS_ROW (widget);
+  RuleDays days = days_row_get_days (self);
+
+  self->tick_id = 0;
+
+  if (days != self->emitted_days)
+    {
+      self->emitted_days = days;
+      g_signal_emit (self,
+                     obj_signals[SIGNAL_VALUE_UPDATED],
+                     0);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+days_row_queue_value_updated (DaysRow *self)
 {
-  gtk_toggle_button_set_active (self->day_0, days[0]);
-  gtk_toggle_button_set_active (self->day_1, days[1]);
-  gtk_toggle_button_set_active (self->day_2, days[2]);
-  gtk_toggle_button_set_active (self->day_3, days[3]);
-  gtk_toggle_button_set_active (self->day_4, days[4]);
-  gtk_toggle_button_set_active (self->day_5, days[5]);
-  gtk_toggle_button_set_active (self->day_6, days[6]);
+  if (self->tick_id == 0)
+    self->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                  days_row_value_updated_tick,
+                                                  NULL, NULL);
 }
 
 static void
-days_row_emit_value_updated (GtkToggleButton *self,
+days_row_emit_value_updated (GtkToggleButton *button,
                              gpointer         user_data)
 {
-  g_signal_emit (DAYS_ROW (user_data),
-                 obj_signals[SIGNAL_VALUE_UPDATED],
-                 0);
+  days_row_queue_value_updated (DAYS_ROW (user_data));
+}
+
+void
+days_row_set_days (DaysRow  *self,
+                   RuleDays  days)
+{
+  gtk_toggle_button_set_active (self->day_0, rule_days_has (days, 0));
+  gtk_toggle_button_set_active (self->day_1, rule_days_has (days, 1));
+  gtk_toggle_button_set_active (self->day_2, rule_days_has (days, 2));
+  gtk_toggle_button_set_active (self->day_3, rule_days_has (days, 3));
+  gtk_toggle_button_set_active (self->day_4, rule_days_has (days, 4));
+  gtk_toggle_button_set_active (self->day_5, rule_days_has (days, 5));
+  gtk_toggle_button_set_active (self->day_6, rule_days_has (days, 6));
+
+  // Toggling programmatically doesn't emit "clicked"
+  days_row_queue_value_updated (self);
 }
 
 static void
@@ -110,7 +148,7 @@ days_row_set_property (GObject      *object,
   switch (property_id)
     {
     case PROP_ID:
-      self->rule_id = (uint16_t) g_value_get_int (value);
+      self->rule_id = g_value_get_uint (value);
       break;
 
     case PROP_TABLE:
@@ -184,6 +222,14 @@ days_row_constructed (GObject *gobject)
 static void
 days_row_dispose (GObject *gobject)
 {
+  DaysRow *self = DAYS_ROW (gobject);
+
+  if (self->tick_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->tick_id);
+      self->tick_id = 0;
+    }
+
   gtk_widget_dispose_template (GTK_WIDGET (gobject), DAYS_TYPE_ROW);
 
   G_OBJECT_CLASS (days_row_parent_class)->dispose (gobject);
@@ -208,13 +254,13 @@ days_row_class_init (DaysRowClass *klass)
 
   // Properties
   obj_properties[PROP_ID] =
-    g_param_spec_int ("id",
-                      NULL, NULL,
-                      0, UINT16_MAX,
-                      0,
-                      G_PARAM_CONSTRUCT_ONLY |
-                      G_PARAM_WRITABLE |
-                      G_PARAM_STATIC_NAME);
+    g_param_spec_uint ("id",
+                       NULL, NULL,
+                       0, G_MAXUINT32,
+                       0,
+                       G_PARAM_CONSTRUCT_ONLY |
+                       G_PARAM_WRITABLE |
+                       G_PARAM_STATIC_NAME);
 
   obj_properties[PROP_TABLE] =
     g_param_spec_int ("table",
@@ -260,6 +306,8 @@ days_row_init (DaysRow *self)
 
   self->rule_id = 0;
   self->table = TABLE_LAST;
+  self->emitted_days = RULE_DAYS_NONE;
+  self->tick_id = 0;
 
   // Signals
   g_signal_connect (self->day_0,
@@ -23,6 +23,7 @@
 #include <adwaita.h>
 
 #include "database-connection/database-connection.h"
+#include "rule-days.h"
 
 G_BEGIN_DECLS
 
@@ -31,7 +32,7 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (DaysRow, days_row, DAYS, ROW, GtkBox)
 
 DaysRow *days_row_new (gboolean interactive);
-void days_row_get_activated (DaysRow *self, bool *days);
-void days_row_set_activated (DaysRow *self, bool days[7]);
+RuleDays days_row_get_days (DaysRow *self);
+void days_row_set_days (DaysRow *self, RuleDays days);
 
 G_END_DECLS
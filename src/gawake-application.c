@@ -24,6 +24,7 @@
 #include "gawake-application.h"
 #include "gawake-window.h"
 #include "gawake-preferences.h"
+#include "gawake-timing.h"
 
 struct _GawakeApplication
 {
@@ -65,12 +66,18 @@ gawake_application_activate (GApplication *app)
 
   g_assert (GAWAKE_IS_APPLICATION (app));
 
+  gawake_timing_end ("application-startup");
+
   window = gtk_application_get_active_window (GTK_APPLICATION (app));
 
   if (window == NULL)
-    window = g_object_new (GAWAKE_TYPE_WINDOW,
-                           "application", app,
-                           NULL);
+    {
+      gawake_timing_begin ("window-init");
+      window = g_object_new (GAWAKE_TYPE_WINDOW,
+                             "application", app,
+                             NULL);
+      gawake_timing_end ("window-init");
+    }
 
   gtk_window_present (window);
 }
@@ -0,0 +1,123 @@
+/* gawake-benchmark.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Scaling benchmark of the in-memory rule structures:
+ *
+ *   gawake-benchmark COUNT
+ *
+ * generates COUNT synthetic rules (see rule-generator.c) and times filling
+ * and querying the conflict index and the fire queue, and building the repeat
+ * labels. Results are printed as gawake-timing records (JSON Lines, unless
+ * GAWAKE_TIMING is already set), with the number of rules involved.
+ *
+ * It doesn't touch the database; "gawake --cli generate" seeds one instead.
+ */
+
+#include <stdlib.h>
+
+#include "gawake-timing.h"
+#include "rule-days.h"
+#include "rule-fire-queue.h"
+#include "rule-generator.h"
+#include "rule-time-index.h"
+
+#define BENCHMARK_SEED      42
+#define BENCHMARK_LOOKUPS   1000
+#define BENCHMARK_WINDOW    5     // minutes, as the default "conflict-window"
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_autoptr (GRand) rand = NULL;
+  g_autoptr (GArray) rules = NULL;
+  g_autoptr (GArray) conflicts = NULL;
+  g_autoptr (RuleTimeIndex) index = NULL;
+  g_autoptr (RuleFireQueue) queue = NULL;
+  g_autoptr (GDateTime) now = NULL;
+  guint64 count;
+  gint64 start;
+
+  if (argc != 2 || !g_ascii_string_to_unsigned (argv[1], 10, 1, G_MAXUINT32, &count, NULL))
+    {
+      g_printerr ("Usage: %s COUNT\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  g_setenv ("GAWAKE_TIMING", "json", FALSE);
+  gawake_timing_init ();
+
+  rand = g_rand_new_with_seed (BENCHMARK_SEED);
+  rules = g_array_sized_new (FALSE, FALSE, sizeof (Rule), (guint) count);
+  g_array_set_size (rules, (guint) count);
+
+  start = gawake_timing_now ();
+  for (guint32 number = 1; number <= count; number++)
+    rule_generator_fill (rand, number, TABLE_OFF, &g_array_index (rules, Rule, number - 1));
+  gawake_timing_record ("generate", start, (gint) count);
+
+  // Conflict index
+  index = rule_time_index_new ();
+
+  start = gawake_timing_now ();
+  for (guint i = 0; i < rules->len; i++)
+    rule_time_index_add (index, &g_array_index (rules, Rule, i));
+  gawake_timing_record ("index-add", start, (gint) count);
+
+  conflicts = g_array_new (FALSE, FALSE, sizeof (Rule));
+
+  start = gawake_timing_now ();
+  for (guint i = 0; i < BENCHMARK_LOOKUPS; i++)
+    {
+      g_array_set_size (conflicts, 0);
+      rule_time_index_collect (index,
+                               0,
+                               (guint8) g_rand_int_range (rand, 0, 24),
+                               (guint8) g_rand_int_range (rand, 0, 60),
+                               (RuleDays) g_rand_int_range (rand, 1, RULE_DAYS_ALL + 1),
+                               BENCHMARK_WINDOW,
+                               conflicts);
+    }
+  gawake_timing_record ("index-collect", start, (gint) count);
+
+  // Fire queue
+  queue = rule_fire_queue_new ();
+
+  start = gawake_timing_now ();
+  for (guint i = 0; i < rules->len; i++)
+    rule_fire_queue_add (queue, &g_array_index (rules, Rule, i));
+  gawake_timing_record ("fire-queue-add", start, (gint) count);
+
+  now = g_date_time_new_now_local ();
+
+  start = gawake_timing_now ();
+  for (guint i = 0; i < BENCHMARK_LOOKUPS; i++)
+    rule_fire_queue_peek (queue, now, NULL, NULL);
+  gawake_timing_record ("fire-queue-peek", start, (gint) count);
+
+  // Repeat labels, as shown on each row
+  start = gawake_timing_now ();
+  for (guint i = 0; i < rules->len; i++)
+    rule_days_get_label (rule_days_from_array (g_array_index (rules, Rule, i).days));
+  gawake_timing_record ("days-labels", start, (gint) count);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,808 @@
+/* gawake-cli.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Command line interface, for provisioning rules from scripts:
+ *
+ *   gawake --cli COMMAND [OPTION…] [ID…]
+ *
+ * It uses database-connection directly, without initializing GTK nor
+ * libadwaita. Rules are printed as tab-separated values:
+ *
+ *   id <tab> name <tab> HH:MM <tab> days <tab> active <tab> mode
+ *
+ * where days are the initials of the days the rule repeats on, from Sunday,
+ * and "-" for the others.
+ *
+ * Whole tables are moved between machines with export/import, as CSV:
+ *
+ *   name,time,days,active,mode
+ *   "Work days",07:30,-MTWTF-,on,mem
+ *
+ * Ids are not kept: imported rules are added as new ones.
+ *
+ * "generate COUNT [SEED]" writes synthetic rules in the same format, to seed
+ * a throwaway database at a given size (see rule-generator.c).
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+
+#include "config.h"
+
+#include "gawake-cli.h"
+#include "rule-generator.h"
+
+#define ALLOW_MANAGING_RULES
+#define ALLOW_MANAGING_CONFIGURATION
+# include "database-connection/database-connection.h"
+#undef ALLOW_MANAGING_CONFIGURATION
+#undef ALLOW_MANAGING_RULES
+
+typedef gint (*GawakeCliCommand) (Table table, gint argc, gchar **argv);
+
+static gchar *table_option = NULL;
+static gchar *name_option = NULL;
+static gchar *time_option = NULL;
+static gchar *days_option = NULL;
+static gchar *mode_option = NULL;
+static gboolean inactive_option = FALSE;
+
+static const GOptionEntry entries[] =
+{
+  { "table", 't', 0, G_OPTION_ARG_STRING, &table_option, N_("Rule table: “on” (default) or “off”"), N_("TABLE") },
+  { "name", 'n', 0, G_OPTION_ARG_STRING, &name_option, N_("Rule name (add)"), N_("NAME") },
+  { "time", 'T', 0, G_OPTION_ARG_STRING, &time_option, N_("Rule time, 24-hour (add)"), N_("HH:MM") },
+  { "days", 'd', 0, G_OPTION_ARG_STRING, &days_option, N_("Comma-separated days, e.g. “mon,wed”, or “all”, “weekdays”, “weekends” (add)"), N_("DAYS") },
+  { "mode", 'm', 0, G_OPTION_ARG_STRING, &mode_option, N_("rtcwake mode of a turn off rule; the default mode if not given (add)"), N_("MODE") },
+  { "inactive", 0, 0, G_OPTION_ARG_NONE, &inactive_option, N_("Add the rule disabled (add)"), NULL },
+  G_OPTION_ENTRY_NULL
+};
+
+// Short names, indexed as Rule.days: from Sunday
+static const gchar *day_names[7] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+
+static gboolean
+gawake_cli_parse_table (const gchar *text,
+                        Table       *table)
+{
+  if (text == NULL || g_strcmp0 (text, "on") == 0)
+    *table = TABLE_ON;
+  else if (g_strcmp0 (text, "off") == 0)
+    *table = TABLE_OFF;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+gawake_cli_parse_time (const gchar *text,
+                       Rule        *rule)
+{
+  guint hour, minutes;
+  gchar trailing;
+
+  if (text == NULL
+      || sscanf (text, "%u:%u%c", &hour, &minutes, &trailing) != 2
+      || hour > 23
+      || minutes > 59)
+    return FALSE;
+
+  rule->hour = (uint8_t) hour;
+  rule->minutes = (uint8_t) minutes;
+
+  return TRUE;
+}
+
+static gboolean
+gawake_cli_parse_days (const gchar *text,
+                       bool         days[7])
+{
+  g_auto (GStrv) names = NULL;
+
+  for (gint day = 0; day < 7; day++)
+    days[day] = false;
+
+  if (text == NULL)
+    return FALSE;
+
+  if (g_ascii_strcasecmp (text, "all") == 0)
+    {
+      for (gint day = 0; day < 7; day++)
+        days[day] = true;
+      return TRUE;
+    }
+
+  if (g_ascii_strcasecmp (text, "weekdays") == 0)
+    {
+      for (gint day = 1; day < 6; day++)
+        days[day] = true;
+      return TRUE;
+    }
+
+  if (g_ascii_strcasecmp (text, "weekends") == 0)
+    {
+      days[0] = days[6] = true;
+      return TRUE;
+    }
+
+  names = g_strsplit (text, ",", -1);
+  for (gint i = 0; names[i] != NULL; i++)
+    {
+      gint day;
+
+      g_strstrip (names[i]);
+
+      for (day = 0; day < 7; day++)
+        if (g_ascii_strcasecmp (names[i], day_names[day]) == 0)
+          break;
+
+      if (day == 7)
+        return FALSE;
+
+      days[day] = true;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gawake_cli_parse_mode (const gchar *text,
+                       Mode        *mode)
+{
+  for (gint i = 0; i < MODE_LAST; i++)
+    {
+      if (g_ascii_strcasecmp (text, MODE[i]) == 0)
+        {
+          *mode = (Mode) i;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+// database-connection still takes 16-bit ids: larger ones would wrap around
+static gboolean
+gawake_cli_parse_id (const gchar *text,
+                     guint32     *rule_id)
+{
+  guint64 value;
+
+  if (!g_ascii_string_to_unsigned (text, 10, 1, G_MAXUINT16, &value, NULL))
+    return FALSE;
+
+  *rule_id = (guint32) value;
+
+  return TRUE;
+}
+
+// <days> must hold 8 characters
+static void
+gawake_cli_format_days (const Rule *rule,
+                        gchar      *days)
+{
+  for (gint day = 0; day < 7; day++)
+    days[day] = rule->days[day] ? g_ascii_toupper (day_names[day][0]) : '-';
+  days[7] = '\0';
+}
+
+/*
+ * The inverse of gawake_cli_format_days (): each position holds the day's
+ * initial (or "1") when active, and "-" (or "0") when not
+ */
+static gboolean
+gawake_cli_parse_days_mask (const gchar *text,
+                            bool         days[7])
+{
+  if (strlen (text) != 7)
+    return FALSE;
+
+  for (gint day = 0; day < 7; day++)
+    {
+      if (text[day] == '-' || text[day] == '0')
+        days[day] = false;
+      else if (text[day] == '1'
+               || g_ascii_toupper (text[day]) == g_ascii_toupper (day_names[day][0]))
+        days[day] = true;
+      else
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gawake_cli_print_rule (const Rule *rule)
+{
+  gchar days[8];
+
+  gawake_cli_format_days (rule, days);
+
+  g_print ("%u\t%s\t%02u:%02u\t%s\t%s\t%s\n",
+           (guint) rule->id,
+           rule->name,
+           (guint) rule->hour,
+           (guint) rule->minutes,
+           days,
+           rule->active ? "on" : "off",
+           MODE[rule->mode]);
+}
+
+static gint
+gawake_cli_list (Table   table,
+                 gint    argc,
+                 gchar **argv)
+{
+  Rule *rules = NULL;
+  guint16 row_count = 0;
+
+  if (rule_get_all (table, &rules, &row_count) == EXIT_FAILURE)
+    {
+      g_printerr (_("Failed to get rules\n"));
+      return EXIT_FAILURE;
+    }
+
+  for (guint32 row_idx = 0; row_idx < row_count; row_idx++)
+    gawake_cli_print_rule (&rules[row_idx]);
+
+  free (rules);
+
+  return EXIT_SUCCESS;
+}
+
+static gint
+gawake_cli_add (Table   table,
+                gint    argc,
+                gchar **argv)
+{
+  Rule rule = { 0 };
+  guint32 rule_id;
+
+  if (name_option == NULL || time_option == NULL || days_option == NULL)
+    {
+      g_printerr (_("--name, --time and --days are required\n"));
+      return EXIT_FAILURE;
+    }
+
+  g_snprintf (rule.name, RULE_NAME_LENGTH, "%s", name_option);
+
+  if (!gawake_cli_parse_time (time_option, &rule))
+    {
+      g_printerr (_("Invalid time: %s\n"), time_option);
+      return EXIT_FAILURE;
+    }
+
+  if (!gawake_cli_parse_days (days_option, rule.days))
+    {
+      g_printerr (_("Invalid days: %s\n"), days_option);
+      return EXIT_FAILURE;
+    }
+
+  // Only turn off rules have a mode
+  if (mode_option != NULL && table == TABLE_ON)
+    {
+      g_printerr (_("--mode only applies to turn off rules\n"));
+      return EXIT_FAILURE;
+    }
+
+  if (mode_option == NULL)
+    {
+      if (configuration_get_default_mode (&rule.mode) == EXIT_FAILURE)
+        {
+          g_printerr (_("Failed to get the default mode\n"));
+          return EXIT_FAILURE;
+        }
+    }
+  else if (!gawake_cli_parse_mode (mode_option, &rule.mode))
+    {
+      g_printerr (_("Invalid mode: %s\n"), mode_option);
+      return EXIT_FAILURE;
+    }
+
+  rule.active = !inactive_option;
+  rule.table = table;
+
+  if (rule_validate_rule (&rule) == EXIT_FAILURE)
+    {
+      g_printerr (_("Invalid rule\n"));
+      return EXIT_FAILURE;
+    }
+
+  rule_id = rule_add (&rule);
+  if (rule_id == 0)
+    {
+      g_printerr (_("Failed to add rule\n"));
+      return EXIT_FAILURE;
+    }
+
+  // The new id, for scripts
+  g_print ("%u\n", rule_id);
+
+  return EXIT_SUCCESS;
+}
+
+// CSV
+static const gchar *csv_header = "name,time,days,active,mode";
+
+static void
+gawake_cli_csv_append_field (GString     *line,
+                             const gchar *value)
+{
+  if (strpbrk (value, ",\"\r\n") == NULL)
+    {
+      g_string_append (line, value);
+      return;
+    }
+
+  g_string_append_c (line, '"');
+  for (const gchar *c = value; *c != '\0'; c++)
+    {
+      if (*c == '"')
+        g_string_append_c (line, '"');
+      g_string_append_c (line, *c);
+    }
+  g_string_append_c (line, '"');
+}
+
+// Splits a CSV <line> into <fields>; quoted fields may hold commas and quotes
+static gboolean
+gawake_cli_csv_split (const gchar *line,
+                      GPtrArray   *fields)
+{
+  g_autoptr (GString) field = g_string_new (NULL);
+  const gchar *c = line;
+
+  for (;;)
+    {
+      g_string_truncate (field, 0);
+
+      if (*c == '"')
+        {
+          for (c++; ; c++)
+            {
+              if (*c == '\0')
+                return FALSE; // unterminated
+
+              if (*c == '"')
+                {
+                  if (c[1] != '"')
+                    break;
+                  c++;
+                }
+
+              g_string_append_c (field, *c);
+            }
+          c++; // closing quote
+
+          if (*c != ',' && *c != '\0')
+            return FALSE;
+        }
+      else
+        {
+          for (; *c != ',' && *c != '\0'; c++)
+            g_string_append_c (field, *c);
+        }
+
+      g_ptr_array_add (fields, g_strdup (field->str));
+
+      if (*c == '\0')
+        return TRUE;
+
+      c++; // comma
+    }
+}
+
+static gboolean
+gawake_cli_csv_parse_rule (const gchar *line,
+                           Table        table,
+                           Rule        *rule)
+{
+  g_autoptr (GPtrArray) fields = g_ptr_array_new_with_free_func (g_free);
+  const gchar *active = NULL;
+
+  if (!gawake_cli_csv_split (line, fields) || fields->len != 5)
+    return FALSE;
+
+  if (strlen (g_ptr_array_index (fields, 0)) >= RULE_NAME_LENGTH)
+    return FALSE;
+  g_snprintf (rule->name, RULE_NAME_LENGTH, "%s", (gchar *) g_ptr_array_index (fields, 0));
+
+  if (!gawake_cli_parse_time (g_ptr_array_index (fields, 1), rule)
+      || !gawake_cli_parse_days_mask (g_ptr_array_index (fields, 2), rule->days)
+      || !gawake_cli_parse_mode (g_ptr_array_index (fields, 4), &rule->mode))
+    return FALSE;
+
+  active = g_ptr_array_index (fields, 3);
+  if (g_strcmp0 (active, "on") == 0)
+    rule->active = true;
+  else if (g_strcmp0 (active, "off") == 0)
+    rule->active = false;
+  else
+    return FALSE;
+
+  rule->id = 0;
+  rule->table = table;
+
+  return rule_validate_rule (rule) == EXIT_SUCCESS;
+}
+
+static void
+gawake_cli_csv_write_rule (GString    *line,
+                           const Rule *rule,
+                           FILE       *output)
+{
+  gchar days[8];
+
+  gawake_cli_format_days (rule, days);
+
+  g_string_truncate (line, 0);
+  gawake_cli_csv_append_field (line, rule->name);
+  g_string_append_printf (line, ",%02u:%02u,%s,%s,%s\n",
+                          (guint) rule->hour,
+                          (guint) rule->minutes,
+                          days,
+                          rule->active ? "on" : "off",
+                          MODE[rule->mode]);
+
+  fputs (line->str, output);
+}
+
+// export [FILE]: writes the table as CSV, to stdout if no file is given
+static gint
+gawake_cli_export (Table   table,
+                   gint    argc,
+                   gchar **argv)
+{
+  g_autoptr (GString) line = NULL;
+  Rule *rules = NULL;
+  guint16 row_count = 0;
+  FILE *output = stdout;
+  gint ret = EXIT_SUCCESS;
+
+  if (argc > 0 && g_strcmp0 (argv[0], "-") != 0)
+    {
+      output = g_fopen (argv[0], "w");
+      if (output == NULL)
+        {
+          g_printerr (_("Failed to open %s: %s\n"), argv[0], g_strerror (errno));
+          return EXIT_FAILURE;
+        }
+    }
+
+  if (rule_get_all (table, &rules, &row_count) == EXIT_FAILURE)
+    {
+      g_printerr (_("Failed to get rules\n"));
+      ret = EXIT_FAILURE;
+      goto out;
+    }
+
+  line = g_string_sized_new (RULE_NAME_LENGTH + 32);
+  fprintf (output, "%s\n", csv_header);
+
+  for (guint32 row_idx = 0; row_idx < row_count; row_idx++)
+    gawake_cli_csv_write_rule (line, &rules[row_idx], output);
+
+  free (rules);
+
+out:
+  if (output != stdout && fclose (output) != 0)
+    {
+      g_printerr (_("Failed to write %s: %s\n"), argv[0], g_strerror (errno));
+      ret = EXIT_FAILURE;
+    }
+
+  return ret;
+}
+
+/*
+ * import [FILE]: adds the rules of a CSV file (or stdin) to the table.
+ * Every record is parsed and validated before the first one is added, so a
+ * malformed file doesn't leave a partial import behind.
+ */
+static gint
+gawake_cli_import (Table   table,
+                   gint    argc,
+                   gchar **argv)
+{
+  g_autoptr (GIOChannel) input = NULL;
+  g_autoptr (GArray) rules = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree gchar *line = NULL;
+  gsize terminator;
+  guint line_number = 0;
+  GIOStatus status;
+
+  if (argc > 0 && g_strcmp0 (argv[0], "-") != 0)
+    input = g_io_channel_new_file (argv[0], "r", &error);
+  else
+    input = g_io_channel_unix_new (STDIN_FILENO);
+
+  if (input == NULL)
+    {
+      g_printerr (_("Failed to open %s: %s\n"), argv[0], error->message);
+      return EXIT_FAILURE;
+    }
+
+  rules = g_array_new (FALSE, FALSE, sizeof (Rule));
+
+  while ((status = g_io_channel_read_line (input, &line, NULL, &terminator, &error)) == G_IO_STATUS_NORMAL)
+    {
+      Rule rule;
+
+      line_number++;
+      line[terminator] = '\0';
+
+      // Header and empty lines
+      if ((line_number == 1 && g_strcmp0 (line, csv_header) == 0) || line[0] == '\0')
+        {
+          g_clear_pointer (&line, g_free);
+          continue;
+        }
+
+      if (!gawake_cli_csv_parse_rule (line, table, &rule))
+        {
+          g_printerr (_("Invalid rule on line %u\n"), line_number);
+          return EXIT_FAILURE;
+        }
+
+      g_array_append_val (rules, rule);
+      g_clear_pointer (&line, g_free);
+    }
+
+  if (status == G_IO_STATUS_ERROR)
+    {
+      g_printerr (_("Failed to read: %s\n"), error->message);
+      return EXIT_FAILURE;
+    }
+
+  for (guint i = 0; i < rules->len; i++)
+    {
+      if (rule_add (&g_array_index (rules, Rule, i)) == 0)
+        {
+          g_printerr (_("Failed to add rule %u; %u of %u were imported\n"),
+                      i + 1, i, rules->len);
+          return EXIT_FAILURE;
+        }
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// generate COUNT [SEED]: writes COUNT synthetic rules of the table as CSV
+static gint
+gawake_cli_generate (Table   table,
+                     gint    argc,
+                     gchar **argv)
+{
+  g_autoptr (GString) line = NULL;
+  g_autoptr (GRand) rand = NULL;
+  guint64 count, seed = 0;
+
+  // database-connection ids are 16-bit, so that's as much as can be imported
+  if (argc < 1
+      || !g_ascii_string_to_unsigned (argv[0], 10, 1, G_MAXUINT16, &count, NULL))
+    {
+      g_printerr (_("Invalid rule count\n"));
+      return EXIT_FAILURE;
+    }
+
+  if (argc > 1
+      && !g_ascii_string_to_unsigned (argv[1], 10, 0, G_MAXUINT32, &seed, NULL))
+    {
+      g_printerr (_("Invalid seed: %s\n"), argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  rand = g_rand_new_with_seed ((guint32) seed);
+  line = g_string_sized_new (RULE_NAME_LENGTH + 32);
+  g_print ("%s\n", csv_header);
+
+  for (guint32 number = 1; number <= count; number++)
+    {
+      Rule rule;
+
+      rule_generator_fill (rand, number, table, &rule);
+      gawake_cli_csv_write_rule (line, &rule, stdout);
+    }
+
+  return EXIT_SUCCESS;
+}
+
+// Applies <action> to every id on <argv>, going on after a failure
+static gint
+gawake_cli_for_each_id (Table          table,
+                        gint           argc,
+                        gchar        **argv,
+                        gint         (*action) (guint32 rule_id, Table table, gpointer data),
+                        gpointer       data)
+{
+  gint ret = EXIT_SUCCESS;
+
+  if (argc == 0)
+    {
+      g_printerr (_("No rule id given\n"));
+      return EXIT_FAILURE;
+    }
+
+  for (gint i = 0; i < argc; i++)
+    {
+      guint32 rule_id;
+
+      if (!gawake_cli_parse_id (argv[i], &rule_id))
+        {
+          g_printerr (_("Invalid rule id: %s\n"), argv[i]);
+          ret = EXIT_FAILURE;
+          continue;
+        }
+
+      if (action (rule_id, table, data) == EXIT_FAILURE)
+        {
+          g_printerr (_("Failed on rule %s\n"), argv[i]);
+          ret = EXIT_FAILURE;
+        }
+    }
+
+  return ret;
+}
+
+static gint
+gawake_cli_delete_action (guint32  rule_id,
+                          Table    table,
+                          gpointer data)
+{
+  return rule_delete (rule_id, table);
+}
+
+static gint
+gawake_cli_enable_disable_action (guint32  rule_id,
+                                  Table    table,
+                                  gpointer data)
+{
+  return rule_enable_disable (rule_id, table, GPOINTER_TO_INT (data));
+}
+
+static gint
+gawake_cli_delete (Table   table,
+                   gint    argc,
+                   gchar **argv)
+{
+  return gawake_cli_for_each_id (table, argc, argv, gawake_cli_delete_action, NULL);
+}
+
+static gint
+gawake_cli_enable (Table   table,
+                   gint    argc,
+                   gchar **argv)
+{
+  return gawake_cli_for_each_id (table, argc, argv,
+                                 gawake_cli_enable_disable_action, GINT_TO_POINTER (true));
+}
+
+static gint
+gawake_cli_disable (Table   table,
+                    gint    argc,
+                    gchar **argv)
+{
+  return gawake_cli_for_each_id (table, argc, argv,
+                                 gawake_cli_enable_disable_action, GINT_TO_POINTER (false));
+}
+
+static const struct
+{
+  const gchar          *name;
+  GawakeCliCommand      run;
+  gboolean              database;
+} commands[] =
+{
+  { "list", gawake_cli_list, TRUE },
+  { "add", gawake_cli_add, TRUE },
+  { "delete", gawake_cli_delete, TRUE },
+  { "enable", gawake_cli_enable, TRUE },
+  { "disable", gawake_cli_disable, TRUE },
+  { "export", gawake_cli_export, TRUE },
+  { "import", gawake_cli_import, TRUE },
+  { "generate", gawake_cli_generate, FALSE },
+};
+
+/*
+ * <argv>[0] is "--cli"; returns the exit status
+ */
+int
+gawake_cli_run (int   argc,
+                char *argv[])
+{
+  g_autoptr (GOptionContext) context = NULL;
+  g_autoptr (GError) error = NULL;
+  GawakeCliCommand command = NULL;
+  gboolean database = TRUE;
+  Table table;
+
+  context = g_option_context_new (_("COMMAND [ID…|FILE|COUNT]"));
+  g_option_context_set_summary (context,
+                                _("Commands:\n"
+                                  "  list      List the rules of a table\n"
+                                  "  add       Add a rule; prints its id\n"
+                                  "  delete    Delete rules by id\n"
+                                  "  enable    Enable rules by id\n"
+                                  "  disable   Disable rules by id\n"
+                                  "  export    Write a table as CSV, to FILE or stdout\n"
+                                  "  import    Add the rules of a CSV FILE or stdin to a table\n"
+                                  "  generate  Write COUNT synthetic rules as CSV, for testing"));
+  g_option_context_add_main_entries (context, entries, GETTEXT_PACKAGE);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  if (argc < 2)
+    {
+      g_printerr (_("No command given, see --help\n"));
+      return EXIT_FAILURE;
+    }
+
+  for (guint i = 0; i < G_N_ELEMENTS (commands); i++)
+    {
+      if (g_strcmp0 (argv[1], commands[i].name) == 0)
+        {
+          command = commands[i].run;
+          database = commands[i].database;
+        }
+    }
+
+  if (command == NULL)
+    {
+      g_printerr (_("Unknown command: %s\n"), argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  if (!gawake_cli_parse_table (table_option, &table))
+    {
+      g_printerr (_("Invalid table: %s\n"), table_option);
+      return EXIT_FAILURE;
+    }
+
+  // Everything after the command
+  if (!database)
+    return command (table, argc - 2, argv + 2);
+
+#if !FLATPAK
+  if (check_user_group ())
+    {
+      g_printerr (_("The user isn't on the gawake group\n"));
+      return EXIT_FAILURE;
+    }
+#endif
+
+  if (connect_database (false) != SQLITE_OK)
+    {
+      g_printerr (_("Failed to connect to the database\n"));
+      return EXIT_FAILURE;
+    }
+
+  return command (table, argc - 2, argv + 2);
+}
@@ -0,0 +1,191 @@
+/* gawake-clock-format.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * The system clock format (12 or 24-hour), resolved once and shared by the
+ * whole application. It is looked up again only when the
+ * org.gnome.desktop.interface clock-format setting changes, and
+ * "twelve-hour" is notified if it actually did, so the widgets showing
+ * times can follow it.
+ *
+ * Times are formatted into a caller buffer, without allocating; the AM/PM
+ * designators come from the locale, which is fixed for the process.
+ */
+
+#include "gawake-clock-format.h"
+
+struct _GawakeClockFormat
+{
+  GObject               parent_instance;
+
+  // Instance variables
+  gboolean              twelve_hour;
+  gchar                 am[16];
+  gchar                 pm[16];
+  GSettings            *settings;
+};
+
+// Properties
+enum
+{
+  PROP_TWELVE_HOUR = 1,
+
+  N_PROPS
+};
+
+static GParamSpec *obj_properties[N_PROPS];
+
+G_DEFINE_FINAL_TYPE (GawakeClockFormat, gawake_clock_format, G_TYPE_OBJECT)
+
+gboolean
+gawake_clock_format_get_twelve_hour (GawakeClockFormat *self)
+{
+  g_return_val_if_fail (GAWAKE_IS_CLOCK_FORMAT (self), FALSE);
+
+  return self->twelve_hour;
+}
+
+// Writes "HH:MM" or "HH:MM AM" into <buffer>
+void
+gawake_clock_format_format_time (GawakeClockFormat *self,
+                                 guint8             hour,
+                                 guint8             minutes,
+                                 gchar              buffer[GAWAKE_CLOCK_FORMAT_TIME_LENGTH])
+{
+  guint hour12;
+
+  if (!self->twelve_hour)
+    {
+      g_snprintf (buffer, GAWAKE_CLOCK_FORMAT_TIME_LENGTH,
+                  "%02u:%02u", (guint) hour, (guint) minutes);
+      return;
+    }
+
+  hour12 = (hour % 12 == 0) ? 12 : hour % 12;
+  g_snprintf (buffer, GAWAKE_CLOCK_FORMAT_TIME_LENGTH,
+              "%02u:%02u %s", hour12, (guint) minutes,
+              (hour < 12) ? self->am : self->pm);
+}
+
+static void
+gawake_clock_format_update (GawakeClockFormat *self)
+{
+  gboolean twelve_hour = (time_converter_get_format () == TIME_FORMAT_TWELVE);
+
+  if (self->twelve_hour == twelve_hour)
+    return;
+
+  self->twelve_hour = twelve_hour;
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[PROP_TWELVE_HOUR]);
+}
+
+static void
+gawake_clock_format_setting_changed (GSettings   *settings,
+                                     const gchar *key,
+                                     gpointer     user_data)
+{
+  gawake_clock_format_update (GAWAKE_CLOCK_FORMAT (user_data));
+}
+
+static void
+gawake_clock_format_get_property (GObject    *object,
+                                  guint       property_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  GawakeClockFormat *self = GAWAKE_CLOCK_FORMAT (object);
+
+  switch (property_id)
+    {
+    case PROP_TWELVE_HOUR:
+      g_value_set_boolean (value, self->twelve_hour);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+gawake_clock_format_class_init (GawakeClockFormatClass *klass)
+{
+  // Properties
+  obj_properties[PROP_TWELVE_HOUR] =
+    g_param_spec_boolean ("twelve-hour",
+                          NULL, NULL,
+                          FALSE,
+                          G_PARAM_READABLE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_NAME);
+
+  G_OBJECT_CLASS (klass)->get_property = gawake_clock_format_get_property;
+  g_object_class_install_properties (G_OBJECT_CLASS (klass),
+                                     N_PROPS,
+                                     obj_properties);
+}
+
+static void
+gawake_clock_format_init (GawakeClockFormat *self)
+{
+  GSettingsSchemaSource *source = NULL;
+  g_autoptr (GSettingsSchema) schema = NULL;
+  g_autoptr (GDateTime) morning = NULL;
+  g_autoptr (GDateTime) afternoon = NULL;
+  g_autofree gchar *am = NULL;
+  g_autofree gchar *pm = NULL;
+
+  self->twelve_hour = (time_converter_get_format () == TIME_FORMAT_TWELVE);
+  self->settings = NULL;
+
+  // Locale designators
+  morning = g_date_time_new_utc (2000, 1, 1, 9, 0, 0);
+  afternoon = g_date_time_new_utc (2000, 1, 1, 21, 0, 0);
+  am = g_date_time_format (morning, "%p");
+  pm = g_date_time_format (afternoon, "%p");
+
+  g_snprintf (self->am, sizeof (self->am), "%s", (am != NULL) ? am : "AM");
+  g_snprintf (self->pm, sizeof (self->pm), "%s", (pm != NULL) ? pm : "PM");
+
+  // Watch the setting, if its schema is installed
+  source = g_settings_schema_source_get_default ();
+  if (source != NULL)
+    schema = g_settings_schema_source_lookup (source, "org.gnome.desktop.interface", TRUE);
+
+  if (schema != NULL && g_settings_schema_has_key (schema, "clock-format"))
+    {
+      self->settings = g_settings_new_full (schema, NULL, NULL);
+      g_signal_connect (self->settings,
+                        "changed::clock-format",
+                        G_CALLBACK (gawake_clock_format_setting_changed),
+                        self);
+    }
+}
+
+// The shared instance; it lives as long as the process
+GawakeClockFormat *
+gawake_clock_format_get_default (void)
+{
+  static GawakeClockFormat *clock_format = NULL;
+
+  if (clock_format == NULL)
+    clock_format = GAWAKE_CLOCK_FORMAT (g_object_new (GAWAKE_TYPE_CLOCK_FORMAT, NULL));
+
+  return clock_format;
+}
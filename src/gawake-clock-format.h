@@ -0,0 +1,44 @@
+/* gawake-clock-format.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "database-connection/database-connection.h"
+
+G_BEGIN_DECLS
+
+// "HH:MM" plus the longest AM/PM designator
+#define GAWAKE_CLOCK_FORMAT_TIME_LENGTH 24
+
+#define GAWAKE_TYPE_CLOCK_FORMAT (gawake_clock_format_get_type ())
+
+G_DECLARE_FINAL_TYPE (GawakeClockFormat, gawake_clock_format, GAWAKE, CLOCK_FORMAT, GObject)
+
+GawakeClockFormat *gawake_clock_format_get_default (void);
+
+gboolean gawake_clock_format_get_twelve_hour (GawakeClockFormat *self);
+void gawake_clock_format_format_time (GawakeClockFormat *self,
+                                      guint8             hour,
+                                      guint8             minutes,
+                                      gchar              buffer[GAWAKE_CLOCK_FORMAT_TIME_LENGTH]);
+
+G_END_DECLS
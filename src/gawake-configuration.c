@@ -0,0 +1,443 @@
+/* gawake-configuration.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * In-memory snapshot of the configuration, shared by the whole application:
+ * it is read from the database once, and the values are exposed as
+ * properties, so widgets can be bound to them.
+ *
+ * Changed values are not written right away: they are flushed together (one
+ * task, only the changed fields) once no other change comes for FLUSH_DELAY_MS,
+ * or when gawake_configuration_flush () is called, e.g. on close-request.
+ */
+
+#include "gawake-configuration.h"
+
+#define FLUSH_DELAY_MS 500
+
+struct _GawakeConfiguration
+{
+  GObject                       parent_instance;
+
+  // Instance variables
+  DatabaseConfiguration         values;
+  DatabaseConfigurationField    dirty;          // changed, not written yet
+  DatabaseConfigurationField    writing;        // being written
+  DatabaseConfigurationField    failed;         // could not be read
+  gboolean                      loaded;
+  gboolean                      loading;
+  gboolean                      flushing;
+  gboolean                      held;
+  guint                         flush_source_id;
+};
+
+// Properties
+enum
+{
+  PROP_LOADED = 1,
+  PROP_SHUTDOWN_FAIL,
+  PROP_NOTIFICATION_TIME,
+  PROP_DEFAULT_MODE,
+  PROP_USE_LOCALTIME,
+
+  N_PROPS
+};
+
+static GParamSpec *obj_properties[N_PROPS];
+
+// Signals
+enum
+{
+  SIGNAL_WRITE_FAILED,
+
+  N_SIGNALS
+};
+
+static guint obj_signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE (GawakeConfiguration, gawake_configuration, G_TYPE_OBJECT)
+
+static void gawake_configuration_write (GawakeConfiguration *self);
+
+/*
+ * The application is held from the first change until it's written (or the
+ * write failed), so it doesn't exit with changes not saved yet
+ */
+static void
+gawake_configuration_hold (GawakeConfiguration *self)
+{
+  if (self->held || g_application_get_default () == NULL)
+    return;
+
+  g_application_hold (g_application_get_default ());
+  self->held = TRUE;
+}
+
+static void
+gawake_configuration_release (GawakeConfiguration *self)
+{
+  if (!self->held)
+    return;
+
+  g_application_release (g_application_get_default ());
+  self->held = FALSE;
+}
+
+static gboolean
+gawake_configuration_flush_timeout (gpointer user_data)
+{
+  GawakeConfiguration *self = GAWAKE_CONFIGURATION (user_data);
+
+  self->flush_source_id = 0;
+  gawake_configuration_write (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gawake_configuration_write_ready (GObject      *source_object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data)
+{
+  GawakeConfiguration *self = GAWAKE_CONFIGURATION (source_object);
+  g_autoptr (GError) error = NULL;
+  gboolean failed = FALSE;
+
+  self->flushing = FALSE;
+
+  if (!database_async_configuration_set_finish (result, &error))
+    {
+      g_warning ("Failed to save configuration: %s", error->message);
+
+      /* Still to be written, so the database catches up with the next change
+       * or flush; not retried right away, as it would likely fail again
+       */
+      self->dirty |= self->writing;
+      failed = TRUE;
+
+      g_signal_emit (self,
+                     obj_signals[SIGNAL_WRITE_FAILED],
+                     0);
+    }
+
+  self->writing = 0;
+
+  // Changed while writing
+  if (!failed && self->dirty != 0 && self->flush_source_id == 0)
+    {
+      gawake_configuration_write (self);
+      return;
+    }
+
+  // Nothing else is due
+  if (self->flush_source_id == 0)
+    gawake_configuration_release (self);
+}
+
+static void
+gawake_configuration_write (GawakeConfiguration *self)
+{
+  // Written once the running write is done
+  if (self->flushing || self->dirty == 0)
+    return;
+
+  self->flushing = TRUE;
+  self->writing = self->dirty;
+  self->dirty = 0;
+
+  gawake_configuration_hold (self);
+
+  database_async_configuration_set (self,
+                                    &self->values,
+                                    self->writing,
+                                    NULL,
+                                    gawake_configuration_write_ready,
+                                    NULL);
+}
+
+// Writes the pending changes now
+void
+gawake_configuration_flush (GawakeConfiguration *self)
+{
+  g_return_if_fail (GAWAKE_IS_CONFIGURATION (self));
+
+  g_clear_handle_id (&self->flush_source_id, g_source_remove);
+  gawake_configuration_write (self);
+}
+
+// Marks <field> as changed, and (re)starts the flush timeout
+static void
+gawake_configuration_changed (GawakeConfiguration        *self,
+                              DatabaseConfigurationField  field,
+                              guint                       property_id)
+{
+  self->dirty |= field;
+
+  gawake_configuration_hold (self);
+  g_clear_handle_id (&self->flush_source_id, g_source_remove);
+  self->flush_source_id = g_timeout_add (FLUSH_DELAY_MS,
+                                         gawake_configuration_flush_timeout,
+                                         self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[property_id]);
+}
+
+static void
+gawake_configuration_load_ready (GObject      *source_object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data)
+{
+  GawakeConfiguration *self = GAWAKE_CONFIGURATION (source_object);
+  g_autoptr (GError) error = NULL;
+  DatabaseConfiguration configuration = { 0 };
+
+  self->loading = FALSE;
+
+  if (!database_async_configuration_get_finish (result, &configuration, &error))
+    configuration.failed = DATABASE_CONFIGURATION_FIELD_ALL;
+
+  // Values changed before loading are kept
+  if (!(self->dirty & DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL))
+    self->values.shutdown_fail = configuration.shutdown_fail;
+  if (!(self->dirty & DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME))
+    self->values.notification_time = configuration.notification_time;
+  if (!(self->dirty & DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE))
+    self->values.default_mode = configuration.default_mode;
+  if (!(self->dirty & DATABASE_CONFIGURATION_FIELD_LOCALTIME))
+    self->values.use_localtime = configuration.use_localtime;
+
+  self->failed = configuration.failed;
+  self->loaded = TRUE;
+
+  g_object_freeze_notify (G_OBJECT (self));
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[PROP_SHUTDOWN_FAIL]);
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[PROP_NOTIFICATION_TIME]);
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[PROP_DEFAULT_MODE]);
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[PROP_USE_LOCALTIME]);
+  g_object_notify_by_pspec (G_OBJECT (self), obj_properties[PROP_LOADED]);
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+// Reads the configuration, if not read yet; "notify::loaded" tells when it's done
+void
+gawake_configuration_load (GawakeConfiguration *self)
+{
+  g_return_if_fail (GAWAKE_IS_CONFIGURATION (self));
+
+  if (self->loaded || self->loading)
+    return;
+
+  self->loading = TRUE;
+
+  database_async_configuration_get (self,
+                                    NULL,
+                                    gawake_configuration_load_ready,
+                                    NULL);
+}
+
+gboolean
+gawake_configuration_get_loaded (GawakeConfiguration *self)
+{
+  g_return_val_if_fail (GAWAKE_IS_CONFIGURATION (self), FALSE);
+
+  return self->loaded;
+}
+
+// The fields that could not be read
+DatabaseConfigurationField
+gawake_configuration_get_failed (GawakeConfiguration *self)
+{
+  g_return_val_if_fail (GAWAKE_IS_CONFIGURATION (self), DATABASE_CONFIGURATION_FIELD_ALL);
+
+  return self->failed;
+}
+
+static void
+gawake_configuration_get_property (GObject    *object,
+                                   guint       property_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  GawakeConfiguration *self = GAWAKE_CONFIGURATION (object);
+
+  switch (property_id)
+    {
+    case PROP_LOADED:
+      g_value_set_boolean (value, self->loaded);
+      break;
+
+    case PROP_SHUTDOWN_FAIL:
+      g_value_set_boolean (value, self->values.shutdown_fail);
+      break;
+
+    case PROP_NOTIFICATION_TIME:
+      g_value_set_int (value, self->values.notification_time);
+      break;
+
+    case PROP_DEFAULT_MODE:
+      g_value_set_uint (value, (guint) self->values.default_mode);
+      break;
+
+    case PROP_USE_LOCALTIME:
+      g_value_set_boolean (value, self->values.use_localtime);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+gawake_configuration_set_property (GObject      *object,
+                                   guint         property_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  GawakeConfiguration *self = GAWAKE_CONFIGURATION (object);
+
+  // Only actual changes are written
+  switch (property_id)
+    {
+    case PROP_SHUTDOWN_FAIL:
+      if (self->values.shutdown_fail != (bool) g_value_get_boolean (value))
+        {
+          self->values.shutdown_fail = (bool) g_value_get_boolean (value);
+          gawake_configuration_changed (self, DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL, property_id);
+        }
+      break;
+
+    case PROP_NOTIFICATION_TIME:
+      if (self->values.notification_time != g_value_get_int (value))
+        {
+          self->values.notification_time = g_value_get_int (value);
+          gawake_configuration_changed (self, DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME, property_id);
+        }
+      break;
+
+    case PROP_DEFAULT_MODE:
+      if ((guint) self->values.default_mode != g_value_get_uint (value))
+        {
+          self->values.default_mode = (Mode) g_value_get_uint (value);
+          gawake_configuration_changed (self, DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE, property_id);
+        }
+      break;
+
+    case PROP_USE_LOCALTIME:
+      if (self->values.use_localtime != (bool) g_value_get_boolean (value))
+        {
+          self->values.use_localtime = (bool) g_value_get_boolean (value);
+          gawake_configuration_changed (self, DATABASE_CONFIGURATION_FIELD_LOCALTIME, property_id);
+        }
+      break;
+
+    case PROP_LOADED:
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+gawake_configuration_class_init (GawakeConfigurationClass *klass)
+{
+  // Properties
+  obj_properties[PROP_LOADED] =
+    g_param_spec_boolean ("loaded",
+                          NULL, NULL,
+                          FALSE,
+                          G_PARAM_READABLE |
+                          G_PARAM_STATIC_NAME);
+
+  obj_properties[PROP_SHUTDOWN_FAIL] =
+    g_param_spec_boolean ("shutdown-fail",
+                          NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_NAME);
+
+  obj_properties[PROP_NOTIFICATION_TIME] =
+    g_param_spec_int ("notification-time",
+                      NULL, NULL,
+                      0, G_MAXINT,
+                      0,
+                      G_PARAM_READWRITE |
+                      G_PARAM_EXPLICIT_NOTIFY |
+                      G_PARAM_STATIC_NAME);
+
+  obj_properties[PROP_DEFAULT_MODE] =
+    g_param_spec_uint ("default-mode",
+                       NULL, NULL,
+                       0, (MODE_LAST-1),
+                       0,
+                       G_PARAM_READWRITE |
+                       G_PARAM_EXPLICIT_NOTIFY |
+                       G_PARAM_STATIC_NAME);
+
+  obj_properties[PROP_USE_LOCALTIME] =
+    g_param_spec_boolean ("use-localtime",
+                          NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_NAME);
+
+  G_OBJECT_CLASS (klass)->get_property = gawake_configuration_get_property;
+  G_OBJECT_CLASS (klass)->set_property = gawake_configuration_set_property;
+  g_object_class_install_properties (G_OBJECT_CLASS (klass),
+                                     N_PROPS,
+                                     obj_properties);
+
+  // Signals
+  obj_signals[SIGNAL_WRITE_FAILED] =
+    g_signal_new ("write-failed",
+                  GAWAKE_TYPE_CONFIGURATION,
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE,            // no return value
+                  0);                     // 0 arguments
+}
+
+static void
+gawake_configuration_init (GawakeConfiguration *self)
+{
+  self->values = (DatabaseConfiguration) { 0 };
+  self->dirty = 0;
+  self->writing = 0;
+  self->failed = 0;
+  self->loaded = FALSE;
+  self->loading = FALSE;
+  self->flushing = FALSE;
+  self->held = FALSE;
+  self->flush_source_id = 0;
+}
+
+// The shared instance; it lives as long as the process
+GawakeConfiguration *
+gawake_configuration_get_default (void)
+{
+  static GawakeConfiguration *configuration = NULL;
+
+  if (configuration == NULL)
+    configuration = GAWAKE_CONFIGURATION (g_object_new (GAWAKE_TYPE_CONFIGURATION, NULL));
+
+  return configuration;
+}
@@ -0,0 +1,41 @@
+/* gawake-configuration.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "database-async.h"
+
+G_BEGIN_DECLS
+
+#define GAWAKE_TYPE_CONFIGURATION (gawake_configuration_get_type ())
+
+G_DECLARE_FINAL_TYPE (GawakeConfiguration, gawake_configuration, GAWAKE, CONFIGURATION, GObject)
+
+GawakeConfiguration *gawake_configuration_get_default (void);
+
+void gawake_configuration_load (GawakeConfiguration *self);
+gboolean gawake_configuration_get_loaded (GawakeConfiguration *self);
+DatabaseConfigurationField gawake_configuration_get_failed (GawakeConfiguration *self);
+
+void gawake_configuration_flush (GawakeConfiguration *self);
+
+G_END_DECLS
@@ -20,9 +20,7 @@
 
 #include <glib/gi18n.h>
 
-#define ALLOW_MANAGING_CONFIGURATION
-# include "database-connection/database-connection.h"
-#undef ALLOW_MANAGING_CONFIGURATION
+#include "gawake-configuration.h"
 
 #include "mode-row.h"
 
@@ -45,178 +43,185 @@ struct _GawakePreferences
 
 G_DEFINE_FINAL_TYPE (GawakePreferences, gawake_preferences, ADW_TYPE_PREFERENCES_WINDOW)
 
-static gboolean
-gawake_preferences_switch_state_set (GtkSwitch *switch_button,
-                                     gboolean   state,
-                                     gpointer   user_data)
-{
-  GawakePreferences *self = GAWAKE_PREFERENCES (user_data);
-  gint status = EXIT_FAILURE;
-
-  if (switch_button == GTK_SWITCH (self->shutdown_switch))
-    status = configuration_set_shutdown_fail ((bool) state);
-  else if (switch_button == GTK_SWITCH (self->localtime_switch))
-    status = configuration_set_localtime ((bool) state);
-  else
-    g_warning ("Invalid swicth");
-
-  if (status == EXIT_FAILURE)
-    {
-      adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
-                                            adw_toast_new (_("Operation failed")));
-      gtk_switch_set_active (switch_button, !status);
-      return TRUE;
-    }
-
-  return FALSE;
-}
-
 static void
-gawake_preferences_notification_changed (GtkSpinButton *spin_button,
-                                         gpointer       user_data)
+gawake_preferences_write_failed (GawakeConfiguration *configuration,
+                                 gpointer             user_data)
 {
-  gdouble new_value = 1;
-  GawakePreferences *self = GAWAKE_PREFERENCES (user_data);
-
-  new_value = gtk_spin_button_get_value (spin_button);
-
-  if (configuration_set_notification_time ((int) new_value) == EXIT_FAILURE)
-    adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
-                                      adw_toast_new (_("Operation failed")));
+  adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (user_data),
+                                    adw_toast_new (_("Operation failed")));
 }
 
 static gboolean
 gawake_preferences_on_close_request (GtkWindow *self,
                                      gpointer   user_data)
 {
-  Mode mode = mode_row_get_mode (GAWAKE_PREFERENCES (self)->mode_row);
-
-  if (configuration_set_default_mode (mode) == EXIT_FAILURE)
-    g_warning ("Failed to save default mode");
-  else
-    g_info ("Default mode saved successfully");
+  // Don't wait for the flush timeout; the write outlives the window
+  gawake_configuration_flush (gawake_configuration_get_default ());
 
   return FALSE;
 }
 
+/*
+ * The rows are bound to the shared configuration: changes are written by it,
+ * coalesced, so e.g. holding the spin button arrow doesn't write every step
+ */
 static void
-gawake_preferences_dispose (GObject *gobject)
-{
-  gtk_widget_dispose_template (GTK_WIDGET (gobject), GAWAKE_TYPE_PREFERENCES);
-
-  G_OBJECT_CLASS (gawake_preferences_parent_class)->dispose (gobject);
-}
-
-static void
-gawake_preferences_class_init (GawakePreferencesClass *klass)
-{
-  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
-
-  gtk_widget_class_set_template_from_resource (widget_class,
-                                               "/io/github/gawake/Gawake/gawake-preferences.ui");
-
-  // Widgets
-  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, shutdown_action_row);
-  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, mode_row);
-  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, localtime_action_row);
-  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, notification_time_row);
-
-  G_OBJECT_CLASS (klass)->dispose = gawake_preferences_dispose;
-}
-
-static void
-gawake_preferences_init (GawakePreferences *self)
+gawake_preferences_build (GawakePreferences *self)
 {
-  bool shutdown_fail = FALSE;
-  bool use_localtime = FALSE;
-  gint notification_time = 1;
-  Mode default_mode = MODE_OFF;
-
-  // Ensure my custom widgets types
-  g_type_ensure (MODE_TYPE_ROW);
+  GawakeConfiguration *configuration = gawake_configuration_get_default ();
+  DatabaseConfigurationField failed = gawake_configuration_get_failed (configuration);
 
-  gtk_widget_init_template (GTK_WIDGET (self));
+  if (failed != 0)
+    adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
+                                      adw_toast_new (_("Failed to get configuration")));
 
   // SHUTDOWN ON FAILURE
-  if (configuration_get_shutdown_fail (&shutdown_fail))
+  if (failed & DATABASE_CONFIGURATION_FIELD_SHUTDOWN_FAIL)
     {
-      adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
-                                        adw_toast_new (_("Failed to get configuration")));
-      gtk_widget_set_sensitive (GTK_WIDGET (self->shutdown_switch), FALSE);
+      gtk_widget_set_sensitive (GTK_WIDGET (self->shutdown_action_row), FALSE);
     }
   else
     {
       // Note [1]
       self->shutdown_switch = gtk_switch_new ();
       gtk_widget_set_valign (self->shutdown_switch, GTK_ALIGN_CENTER);
-      gtk_switch_set_state (GTK_SWITCH (self->shutdown_switch), shutdown_fail);
-      gtk_switch_set_active (GTK_SWITCH (self->shutdown_switch), shutdown_fail);
       adw_action_row_add_suffix (self->shutdown_action_row, self->shutdown_switch);
       adw_action_row_set_activatable_widget (self->shutdown_action_row, self->shutdown_switch);
-      g_signal_connect (self->shutdown_switch,
-                        "state-set",
-                        G_CALLBACK (gawake_preferences_switch_state_set),
-                        self);
+      g_object_bind_property (configuration, "shutdown-fail",
+                              self->shutdown_switch, "active",
+                              G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
     }
 
   // NOTIFICATION TIME
-  if (configuration_get_notification_time (&notification_time))
+  if (failed & DATABASE_CONFIGURATION_FIELD_NOTIFICATION_TIME)
     {
-      adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
-                                        adw_toast_new (_("Failed to get configuration")));
-      gtk_widget_set_sensitive (GTK_WIDGET (self->notification_spin_button), FALSE);
+      gtk_widget_set_sensitive (GTK_WIDGET (self->notification_time_row), FALSE);
     }
   else
     {
       self->notification_spin_button = GTK_SPIN_BUTTON (gtk_spin_button_new_with_range (1, 60, 1));
-      gtk_spin_button_set_value (self->notification_spin_button, (gdouble) notification_time);
       gtk_widget_set_valign (GTK_WIDGET (self->notification_spin_button), GTK_ALIGN_CENTER);
       adw_action_row_add_suffix (self->notification_time_row, GTK_WIDGET (self->notification_spin_button));
       adw_action_row_set_activatable_widget (self->notification_time_row, GTK_WIDGET (self->notification_spin_button));
-      g_signal_connect (self->notification_spin_button,
-                        "value-changed",
-                        G_CALLBACK (gawake_preferences_notification_changed),
-                        self);
+      g_object_bind_property (configuration, "notification-time",
+                              self->notification_spin_button, "value",
+                              G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
     }
 
   // DEFAULT MODE
-  if (configuration_get_default_mode (&default_mode))
+  if (failed & DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE)
     {
-      adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
-                                        adw_toast_new (_("Failed to get configuration")));
       gtk_widget_set_sensitive (GTK_WIDGET (self->mode_row), FALSE);
     }
   else
     {
-      mode_row_set_mode (self->mode_row, default_mode);
+      g_object_bind_property (configuration, "default-mode",
+                              self->mode_row, "selected",
+                              G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+      gtk_widget_set_sensitive (GTK_WIDGET (self->mode_row), TRUE);
     }
 
   // USE LOCALTIME
-  if (configuration_get_localtime (&use_localtime))
+  if (failed & DATABASE_CONFIGURATION_FIELD_LOCALTIME)
     {
-      adw_preferences_window_add_toast (ADW_PREFERENCES_WINDOW (self),
-                                        adw_toast_new (_("Failed to get configuration")));
-      gtk_widget_set_sensitive (GTK_WIDGET (self->localtime_switch), FALSE);
+      gtk_widget_set_sensitive (GTK_WIDGET (self->localtime_action_row), FALSE);
     }
   else
     {
       // Note [1]
       self->localtime_switch = gtk_switch_new ();
       gtk_widget_set_valign (self->localtime_switch, GTK_ALIGN_CENTER);
-      gtk_switch_set_state (GTK_SWITCH (self->localtime_switch), use_localtime);
-      gtk_switch_set_active (GTK_SWITCH (self->localtime_switch), use_localtime);
       adw_action_row_add_suffix (self->localtime_action_row, self->localtime_switch);
       adw_action_row_set_activatable_widget (self->localtime_action_row, self->localtime_switch);
-      g_signal_connect (self->localtime_switch,
-                        "state-set",
-                        G_CALLBACK (gawake_preferences_switch_state_set),
-                        self);
+      g_object_bind_property (configuration, "use-localtime",
+                              self->localtime_switch, "active",
+                              G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
     }
+}
+
+static void
+gawake_preferences_configuration_loaded (GObject    *object,
+                                         GParamSpec *pspec,
+                                         gpointer    user_data)
+{
+  GawakePreferences *self = GAWAKE_PREFERENCES (user_data);
+
+  g_signal_handlers_disconnect_by_func (object,
+                                        gawake_preferences_configuration_loaded,
+                                        self);
+
+  gawake_preferences_build (self);
+}
+
+static void
+gawake_preferences_dispose (GObject *gobject)
+{
+  gtk_widget_dispose_template (GTK_WIDGET (gobject), GAWAKE_TYPE_PREFERENCES);
+
+  G_OBJECT_CLASS (gawake_preferences_parent_class)->dispose (gobject);
+}
+
+static void
+gawake_preferences_class_init (GawakePreferencesClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  gtk_widget_class_set_template_from_resource (widget_class,
+                                               "/io/github/gawake/Gawake/gawake-preferences.ui");
+
+  // Widgets
+  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, shutdown_action_row);
+  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, mode_row);
+  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, localtime_action_row);
+  gtk_widget_class_bind_template_child (widget_class, GawakePreferences, notification_time_row);
+
+  G_OBJECT_CLASS (klass)->dispose = gawake_preferences_dispose;
+}
+
+static void
+gawake_preferences_init (GawakePreferences *self)
+{
+  GawakeConfiguration *configuration = NULL;
+
+  // Ensure my custom widgets types
+  g_type_ensure (MODE_TYPE_ROW);
+
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  self->shutdown_switch = NULL;
+  self->localtime_switch = NULL;
+  self->notification_spin_button = NULL;
+
+  configuration = gawake_configuration_get_default ();
+
+  g_signal_connect_object (configuration,
+                           "write-failed",
+                           G_CALLBACK (gawake_preferences_write_failed),
+                           self,
+                           0);
 
   g_signal_connect (self,
                     "close-request",
                     G_CALLBACK (gawake_preferences_on_close_request),
                     NULL);
+
+  // Read once, then kept in memory
+  if (gawake_configuration_get_loaded (configuration))
+    {
+      gawake_preferences_build (self);
+      return;
+    }
+
+  // The rows are filled once the configuration is loaded
+  gtk_widget_set_sensitive (GTK_WIDGET (self->mode_row), FALSE);
+
+  g_signal_connect_object (configuration,
+                           "notify::loaded",
+                           G_CALLBACK (gawake_preferences_configuration_loaded),
+                           self,
+                           0);
+
+  gawake_configuration_load (configuration);
 }
 
 GawakePreferences *
@@ -0,0 +1,149 @@
+/* gawake-timing.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Timing spans for the startup path and the database calls, printed to
+ * stderr as
+ *
+ *   TIMING <tab> name <tab> start (ms since main) <tab> duration (ms) <tab> count
+ *
+ * or, with GAWAKE_TIMING=json, as one JSON object per line, so they can be
+ * collected by scripts. <count> is the number of rows involved, and empty
+ * (or left out) when it doesn't apply.
+ *
+ * They are enabled by building with PREPROCESSOR_DEBUG > 0, or by setting the
+ * GAWAKE_TIMING environment variable; otherwise every call returns at once.
+ * begin/end spans are only used from the main thread; records can be made
+ * from any thread. Names must be static strings.
+ */
+
+#include "gawake-timing.h"
+
+static gboolean enabled = FALSE;
+static gboolean json = FALSE;
+static gint64 origin = 0;
+static GHashTable *open_spans = NULL; // name -> start time
+
+void
+gawake_timing_init (void)
+{
+  enabled = (PREPROCESSOR_DEBUG > 0) || (g_getenv ("GAWAKE_TIMING") != NULL);
+
+  if (!enabled)
+    return;
+
+  json = (g_strcmp0 (g_getenv ("GAWAKE_TIMING"), "json") == 0);
+  origin = g_get_monotonic_time ();
+  open_spans = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+}
+
+gboolean
+gawake_timing_enabled (void)
+{
+  return enabled;
+}
+
+static void
+gawake_timing_print (const gchar *name,
+                     gint64       start,
+                     gint64       end,
+                     gint         count)
+{
+  gdouble start_ms = (start - origin) / 1000.0;
+  gdouble duration_ms = (end - start) / 1000.0;
+
+  // Single calls, so lines from different threads don't interleave
+  if (json && count >= 0)
+    g_printerr ("{\"name\": \"%s\", \"start_ms\": %.3f, \"duration_ms\": %.3f, \"count\": %d}\n",
+                name, start_ms, duration_ms, count);
+  else if (json)
+    g_printerr ("{\"name\": \"%s\", \"start_ms\": %.3f, \"duration_ms\": %.3f}\n",
+                name, start_ms, duration_ms);
+  else if (count >= 0)
+    g_printerr ("TIMING\t%s\t%.3f\t%.3f\t%d\n", name, start_ms, duration_ms, count);
+  else
+    g_printerr ("TIMING\t%s\t%.3f\t%.3f\t\n", name, start_ms, duration_ms);
+}
+
+void
+gawake_timing_begin (const gchar *span)
+{
+  gint64 *start = NULL;
+
+  if (!enabled)
+    return;
+
+  start = g_new (gint64, 1);
+  *start = g_get_monotonic_time ();
+
+  g_hash_table_replace (open_spans, (gpointer) span, start);
+}
+
+void
+gawake_timing_end (const gchar *span)
+{
+  gint64 end;
+  gint64 *start = NULL;
+
+  if (!enabled)
+    return;
+
+  end = g_get_monotonic_time ();
+  start = g_hash_table_lookup (open_spans, span);
+
+  // Not begun, or already ended
+  if (start == NULL)
+    return;
+
+  gawake_timing_print (span, *start, end, -1);
+  g_hash_table_remove (open_spans, span);
+}
+
+// A point in time, e.g. the first frame: printed with a zero duration
+void
+gawake_timing_mark (const gchar *event)
+{
+  gint64 now;
+
+  if (!enabled)
+    return;
+
+  now = g_get_monotonic_time ();
+  gawake_timing_print (event, now, now, -1);
+}
+
+// Start time for gawake_timing_record (); 0 if disabled
+gint64
+gawake_timing_now (void)
+{
+  return enabled ? g_get_monotonic_time () : 0;
+}
+
+// A span from <start> until now, of <count> rows (-1 if not applicable)
+void
+gawake_timing_record (const gchar *name,
+                      gint64       start,
+                      gint         count)
+{
+  if (!enabled)
+    return;
+
+  gawake_timing_print (name, start, g_get_monotonic_time (), count);
+}
@@ -0,0 +1,37 @@
+/* gawake-timing.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void gawake_timing_init (void);
+gboolean gawake_timing_enabled (void);
+
+void gawake_timing_begin (const gchar *span);
+void gawake_timing_end (const gchar *span);
+void gawake_timing_mark (const gchar *event);
+
+gint64 gawake_timing_now (void);
+void gawake_timing_record (const gchar *name, gint64 start, gint count);
+
+G_END_DECLS
@@ -26,6 +26,11 @@
 #include "custom-schedule-face.h"
 #include "rule-face.h"
 #include "error-dialog.h"
+#include "database-monitor.h"
+#include "database-async.h"
+#include "rule-time-index.h"
+#include "gawake-configuration.h"
+#include "gawake-timing.h"
 
 #define ALLOW_MANAGING_RULES
 # include "database-connection/database-connection.h"
@@ -38,6 +43,7 @@ struct _GawakeWindow
   // Template widgets
   AdwToastOverlay         *toast_overlay;
   AdwViewStack            *stack;
+  AdwBin                  *custom_schedule_page;
   AdwBin                  *turn_on_page;
   AdwBin                  *turn_off_page;
   RuleFace                *turn_on_page_face;
@@ -46,11 +52,19 @@ struct _GawakeWindow
   GtkStack                *action_button_stack;
   GtkButton               *add_button;
   GtkButton               *direct_schedule_button;
+  GtkToggleButton         *select_button;
+
+  GtkRevealer             *next_wake_up_revealer;
+  GtkLabel                *next_wake_up_label;
 
   // Instance variables
   GtkWindow               *error_dialog;
   ErrorDialogType          error_dialog_type;
   gint                     database_connection_status;
+  DatabaseMonitor         *database_monitor;
+  guint                    next_wake_up_source_id;
+  guint                    build_turn_on_source_id;
+  GCancellable            *cancellable;
 };
 
 G_DEFINE_FINAL_TYPE (GawakeWindow, gawake_window, ADW_TYPE_APPLICATION_WINDOW)
@@ -97,6 +111,69 @@ gawake_window_add_button_clicked (GtkButton *button,
     }
 }
 
+/*
+ * The direct schedule only uses what's in memory (the turn on rules and the
+ * default mode), so it's available once both were loaded
+ */
+static gboolean
+gawake_window_get_direct_schedule_ready (GawakeWindow *self)
+{
+  GawakeConfiguration *configuration = gawake_configuration_get_default ();
+
+  return self->turn_on_page_face != NULL
+         && rule_face_get_loaded (self->turn_on_page_face)
+         && gawake_configuration_get_loaded (configuration)
+         && !(gawake_configuration_get_failed (configuration) & DATABASE_CONFIGURATION_FIELD_DEFAULT_MODE);
+}
+
+static void
+gawake_window_update_direct_schedule (GawakeWindow *self)
+{
+  gtk_widget_set_sensitive (GTK_WIDGET (self->direct_schedule_button),
+                            gawake_window_get_direct_schedule_ready (self));
+}
+
+static void
+gawake_window_configuration_loaded (GObject    *object,
+                                    GParamSpec *pspec,
+                                    gpointer    user_data)
+{
+  gawake_window_update_direct_schedule (GAWAKE_WINDOW (user_data));
+}
+
+// Gets the upcoming turn on rule from the face's queue, with the default mode
+static RtcwakeArgsReturn
+gawake_window_get_upcoming_on (GawakeWindow *self,
+                               RtcwakeArgs  *rtcwake_args)
+{
+  g_autoptr (GDateTime) fire_time = NULL;
+  Rule rule;
+  guint default_mode;
+
+  if (!gawake_window_get_direct_schedule_ready (self))
+    return RTCWAKE_ARGS_RETURN_FAILURE;
+
+  if (!rule_face_get_upcoming_rule (self->turn_on_page_face, &rule, &fire_time))
+    return RTCWAKE_ARGS_RETURN_NOT_FOUND;
+
+  // Turn on rules have no mode of their own
+  g_object_get (gawake_configuration_get_default (),
+                "default-mode", &default_mode,
+                NULL);
+
+  rtcwake_args->hour = rule.hour;
+  rtcwake_args->minutes = rule.minutes;
+  rtcwake_args->day = (guint8) g_date_time_get_day_of_month (fire_time);
+  rtcwake_args->month = (guint8) g_date_time_get_month (fire_time);
+  rtcwake_args->year = (guint16) g_date_time_get_year (fire_time);
+  rtcwake_args->mode = (Mode) default_mode;
+
+  if (rule_validade_rtcwake_args (rtcwake_args) != EXIT_SUCCESS)
+    return RTCWAKE_ARGS_RETURN_INVALID;
+
+  return RTCWAKE_ARGS_RETURN_SUCESS;
+}
+
 static void
 gawake_window_direct_schedule_button_clicked (GtkButton *button,
                                               gpointer   user_data)
@@ -105,7 +182,7 @@ gawake_window_direct_schedule_button_clicked (GtkButton *button,
   RtcwakeArgs rtcwake_args;
   RtcwakeArgsReturn ret;
 
-  ret = rule_get_upcoming_on (&rtcwake_args, MODE_LAST);
+  ret = gawake_window_get_upcoming_on (self, &rtcwake_args);
 
   switch (ret)
     {
@@ -158,6 +235,189 @@ gawake_window_show_error_dialog (gpointer user_data)
   gtk_window_present (self->error_dialog);
 }
 
+static void
+gawake_window_update_next_wake_up (GawakeWindow *self)
+{
+  g_autoptr (GDateTime) fire_time = NULL;
+  g_autoptr (GDateTime) now = NULL;
+  g_autofree gchar *text = NULL;
+  gint minutes;
+
+  if (self->turn_on_page_face == NULL
+      || !rule_face_get_upcoming_rule (self->turn_on_page_face, NULL, &fire_time))
+    {
+      gtk_revealer_set_reveal_child (self->next_wake_up_revealer, FALSE);
+      return;
+    }
+
+  // Rounded up, so it doesn't show "0 min" on the last minute
+  now = g_date_time_new_now_local ();
+  minutes = (gint) ((g_date_time_difference (fire_time, now) / G_TIME_SPAN_SECOND + 59) / 60);
+
+  if (minutes >= 24 * 60)
+    // translators: time until the next turn on rule, in days and hours
+    text = g_strdup_printf (ngettext ("Next wake-up in %d day %d h",
+                                      "Next wake-up in %d days %d h",
+                                      minutes / (24 * 60)),
+                            minutes / (24 * 60), (minutes % (24 * 60)) / 60);
+  else if (minutes >= 60)
+    // translators: time until the next turn on rule, in hours and minutes
+    text = g_strdup_printf (ngettext ("Next wake-up in %d hour %d min",
+                                      "Next wake-up in %d hours %d min",
+                                      minutes / 60),
+                            minutes / 60, minutes % 60);
+  else
+    // translators: time until the next turn on rule, in minutes
+    text = g_strdup_printf (ngettext ("Next wake-up in %d minute",
+                                      "Next wake-up in %d minutes",
+                                      minutes),
+                            minutes);
+
+  gtk_label_set_text (self->next_wake_up_label, text);
+  gtk_revealer_set_reveal_child (self->next_wake_up_revealer, TRUE);
+}
+
+static void
+gawake_window_schedule_changed (RuleFace *face,
+                                gpointer  user_data)
+{
+  gawake_window_update_next_wake_up (GAWAKE_WINDOW (user_data));
+  gawake_window_update_direct_schedule (GAWAKE_WINDOW (user_data));
+}
+
+static gboolean
+gawake_window_next_wake_up_tick (gpointer user_data)
+{
+  gawake_window_update_next_wake_up (GAWAKE_WINDOW (user_data));
+
+  return G_SOURCE_CONTINUE;
+}
+
+/*
+ * Pages are built the first time they're shown, so only the visible one
+ * costs anything at startup
+ */
+static void
+gawake_window_build_turn_on_face (GawakeWindow *self)
+{
+  if (self->turn_on_page_face != NULL
+      || self->database_connection_status != SQLITE_OK)
+    return;
+
+  self->turn_on_page_face = rule_face_new (RULE_FACE_TYPE_TURN_ON);
+  adw_bin_set_child (self->turn_on_page, GTK_WIDGET (self->turn_on_page_face));
+
+  g_signal_connect (self->turn_on_page_face,
+                    "schedule-changed",
+                    G_CALLBACK (gawake_window_schedule_changed),
+                    self);
+
+  // Keep the "next wake-up" countdown current
+  self->next_wake_up_source_id = g_timeout_add_seconds (30,
+                                                        gawake_window_next_wake_up_tick,
+                                                        self);
+}
+
+static void
+gawake_window_build_turn_off_face (GawakeWindow *self)
+{
+  if (self->turn_off_page_face != NULL
+      || self->database_connection_status != SQLITE_OK)
+    return;
+
+  self->turn_off_page_face = rule_face_new (RULE_FACE_TYPE_TURN_OFF);
+  adw_bin_set_child (self->turn_off_page, GTK_WIDGET (self->turn_off_page_face));
+}
+
+static void
+gawake_window_build_custom_schedule_face (GawakeWindow *self)
+{
+  if (adw_bin_get_child (self->custom_schedule_page) != NULL)
+    return;
+
+  adw_bin_set_child (self->custom_schedule_page, GTK_WIDGET (custom_schedule_face_new ()));
+}
+
+static void
+gawake_window_load_turn_off_index_ready (GObject      *source_object,
+                                         GAsyncResult *result,
+                                         gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+  GawakeWindow *self = NULL;
+  RuleTimeIndex *index = NULL;
+  Rule *rules = NULL;
+  guint32 row_count = 0;
+
+  if (!database_async_rule_get_all_finish (result, &rules, &row_count, &error))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to index the turn off rules: %s", error->message);
+      return;
+    }
+
+  self = GAWAKE_WINDOW (source_object);
+
+  // Once built, the face keeps the index itself
+  if (self->turn_off_page_face == NULL)
+    {
+      index = rule_time_index_get_default (TABLE_OFF);
+
+      rule_time_index_clear (index);
+      for (guint32 row_idx = 0; row_idx < row_count; row_idx++)
+        rule_time_index_add (index, &rules[row_idx]);
+    }
+
+  free (rules);
+}
+
+/*
+ * Turn on rules are also checked against the turn off ones, so their index is
+ * filled even if the turn off page wasn't shown; without building its face
+ */
+static void
+gawake_window_load_turn_off_index (GawakeWindow *self)
+{
+  if (self->turn_off_page_face != NULL)
+    return;
+
+  database_async_rule_get_all (self,
+                               TABLE_OFF,
+                               self->cancellable,
+                               gawake_window_load_turn_off_index_ready,
+                               NULL);
+}
+
+/*
+ * The turn on rules also drive the "next wake-up" label, so that face is
+ * built once the window is idle, even if its page wasn't shown
+ */
+static gboolean
+gawake_window_build_turn_on_face_idle (gpointer user_data)
+{
+  GawakeWindow *self = GAWAKE_WINDOW (user_data);
+
+  self->build_turn_on_source_id = 0;
+  gawake_window_build_turn_on_face (self);
+  gawake_window_load_turn_off_index (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gawake_window_select_button_toggled (GtkToggleButton *button,
+                                     gpointer         user_data)
+{
+  GawakeWindow *self = GAWAKE_WINDOW (user_data);
+  gboolean selection_mode = gtk_toggle_button_get_active (button);
+
+  if (self->turn_on_page_face != NULL)
+    rule_face_set_selection_mode (self->turn_on_page_face, selection_mode);
+
+  if (self->turn_off_page_face != NULL)
+    rule_face_set_selection_mode (self->turn_off_page_face, selection_mode);
+}
+
 static void
 gawake_window_face_changed (GObject    *object,
                             GParamSpec *pspec,
@@ -174,11 +434,83 @@ gawake_window_face_changed (GObject    *object,
   else
     gtk_stack_set_visible_child (self->action_button_stack,
                                  GTK_WIDGET (self->add_button));
+
+  // Leave the selection mode when switching pages
+  gtk_toggle_button_set_active (self->select_button, FALSE);
+  gtk_widget_set_visible (GTK_WIDGET (self->select_button),
+                          g_strcmp0 (page_name, "custom-schedule") != 0);
+
+  /* Build the page on its first time, otherwise pick up changes made
+   * outside the UI; only the changed rules are touched
+   */
+  if (g_strcmp0 (page_name, "custom-schedule") == 0)
+    {
+      gawake_window_build_custom_schedule_face (self);
+    }
+  else if (g_strcmp0 (page_name, "on") == 0)
+    {
+      if (self->turn_on_page_face == NULL)
+        gawake_window_build_turn_on_face (self);
+      else
+        rule_face_refresh (self->turn_on_page_face);
+    }
+  else if (g_strcmp0 (page_name, "off") == 0)
+    {
+      if (self->turn_off_page_face == NULL)
+        gawake_window_build_turn_off_face (self);
+      else
+        rule_face_refresh (self->turn_off_page_face);
+    }
+}
+
+// The database was changed, possibly by another process: refresh both lists
+static void
+gawake_window_database_changed (DatabaseMonitor *monitor,
+                                gpointer         user_data)
+{
+  GawakeWindow *self = GAWAKE_WINDOW (user_data);
+
+  if (self->turn_on_page_face != NULL)
+    rule_face_refresh (self->turn_on_page_face);
+
+  if (self->turn_off_page_face != NULL)
+    rule_face_refresh (self->turn_off_page_face);
+  else
+    gawake_window_load_turn_off_index (self);
+}
+
+static void
+gawake_window_after_paint (GdkFrameClock *frame_clock,
+                           gpointer       user_data)
+{
+  gawake_timing_mark ("first-frame");
+
+  g_signal_handlers_disconnect_by_func (frame_clock,
+                                        gawake_window_after_paint,
+                                        user_data);
+}
+
+static void
+gawake_window_realized (GtkWidget *widget,
+                        gpointer   user_data)
+{
+  g_signal_connect (gtk_widget_get_frame_clock (widget),
+                    "after-paint",
+                    G_CALLBACK (gawake_window_after_paint),
+                    user_data);
 }
 
 static void
 gawake_window_dispose (GObject *gobject)
 {
+  GawakeWindow *self = GAWAKE_WINDOW (gobject);
+
+  g_clear_handle_id (&self->next_wake_up_source_id, g_source_remove);
+  g_clear_handle_id (&self->build_turn_on_source_id, g_source_remove);
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+  g_clear_object (&self->database_monitor);
+
   gtk_widget_dispose_template (GTK_WIDGET (gobject), GAWAKE_TYPE_WINDOW);
 
   G_OBJECT_CLASS (gawake_window_parent_class)->dispose (gobject);
@@ -194,13 +526,17 @@ gawake_window_class_init (GawakeWindowClass *klass)
 
   // Widgets
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, stack);
+  gtk_widget_class_bind_template_child (widget_class, GawakeWindow, custom_schedule_page);
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, turn_on_page);
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, turn_off_page);
 
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, action_button_stack);
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, add_button);
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, direct_schedule_button);
+  gtk_widget_class_bind_template_child (widget_class, GawakeWindow, select_button);
   gtk_widget_class_bind_template_child (widget_class, GawakeWindow, toast_overlay);
+  gtk_widget_class_bind_template_child (widget_class, GawakeWindow, next_wake_up_revealer);
+  gtk_widget_class_bind_template_child (widget_class, GawakeWindow, next_wake_up_label);
 
   G_OBJECT_CLASS (klass)->dispose = gawake_window_dispose;
 }
@@ -209,11 +545,23 @@ static void
 gawake_window_init (GawakeWindow *self)
 {
   self->error_dialog = NULL;
-
-  // Ensure the type of my custom widgets
-  g_type_ensure (CUSTOM_TYPE_SCHEDULE_FACE);
-
+  self->turn_on_page_face = NULL;
+  self->turn_off_page_face = NULL;
+  self->database_monitor = NULL;
+  self->next_wake_up_source_id = 0;
+  self->build_turn_on_source_id = 0;
+  self->cancellable = g_cancellable_new ();
+  self->database_connection_status = SQLITE_ERROR; // not connected yet
+
+  gawake_timing_begin ("window-template");
   gtk_widget_init_template (GTK_WIDGET (self));
+  gawake_timing_end ("window-template");
+
+  if (gawake_timing_enabled ())
+    g_signal_connect (self,
+                      "realize",
+                      G_CALLBACK (gawake_window_realized),
+                      self);
 
   // Signals
   g_signal_connect (self->add_button,
@@ -226,31 +574,59 @@ gawake_window_init (GawakeWindow *self)
                     G_CALLBACK (gawake_window_direct_schedule_button_clicked),
                     self);
 
+  g_signal_connect (self->select_button,
+                    "toggled",
+                    G_CALLBACK (gawake_window_select_button_toggled),
+                    self);
+
   g_signal_connect (self->stack,
                     "notify::visible-child",
                     G_CALLBACK (gawake_window_face_changed),
                     self);
 
+  // Enabled once the turn on rules and the configuration are loaded
+  gtk_widget_set_sensitive (GTK_WIDGET (self->direct_schedule_button), FALSE);
+  g_signal_connect_object (gawake_configuration_get_default (),
+                           "notify::loaded",
+                           G_CALLBACK (gawake_window_configuration_loaded),
+                           self,
+                           0);
+
 #if !FLATPAK
   // Check user group
+  gawake_timing_begin ("check-user-group");
   if (check_user_group ())
     {
+      gawake_timing_end ("check-user-group");
       self->error_dialog_type = ERROR_DIALOG_TYPE_USER_GROUP_ERROR;
       g_timeout_add_once (100, gawake_window_show_error_dialog, self);
       return;
     }
+  gawake_timing_end ("check-user-group");
 #endif
 
   // Database connection
+  gawake_timing_begin ("connect-database");
   self->database_connection_status = connect_database (false);
+  gawake_timing_end ("connect-database");
 
   if (self->database_connection_status == SQLITE_OK)
     {
-      self->turn_on_page_face = rule_face_new (RULE_FACE_TYPE_TURN_ON);
-      adw_bin_set_child (self->turn_on_page, GTK_WIDGET (self->turn_on_page_face));
+      // The visible page; the others are built when shown
+      gawake_window_face_changed (G_OBJECT (self->stack), NULL, self);
+
+      self->build_turn_on_source_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                       gawake_window_build_turn_on_face_idle,
+                                                       self,
+                                                       NULL);
+
+      gawake_configuration_load (gawake_configuration_get_default ());
 
-      self->turn_off_page_face = rule_face_new (RULE_FACE_TYPE_TURN_OFF);
-      adw_bin_set_child (self->turn_off_page, GTK_WIDGET (self->turn_off_page_face));
+      self->database_monitor = database_monitor_new (DATABASE_DIRECTORY);
+      g_signal_connect (self->database_monitor,
+                        "changed",
+                        G_CALLBACK (gawake_window_database_changed),
+                        self);
     }
   else
     {
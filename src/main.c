@@ -23,6 +23,8 @@
 #include <glib/gi18n.h>
 
 #include "gawake-application.h"
+#include "gawake-cli.h"
+#include "gawake-timing.h"
 
 int
 main (int   argc,
@@ -31,10 +33,18 @@ main (int   argc,
 	g_autoptr(GawakeApplication) app = NULL;
 	int ret;
 
+	gawake_timing_init ();
+
 	bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
 	textdomain (GETTEXT_PACKAGE);
 
+	// Headless: no GTK, no window
+	if (argc > 1 && g_strcmp0 (argv[1], "--cli") == 0)
+		return gawake_cli_run (argc - 1, argv + 1);
+
+	gawake_timing_begin ("application-startup");
+
 	app = gawake_application_new ("io.github.gawake.Gawake", G_APPLICATION_DEFAULT_FLAGS);
 	ret = g_application_run (G_APPLICATION (app), argc, argv);
 
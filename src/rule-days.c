@@ -0,0 +1,125 @@
+/* rule-days.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <glib/gi18n.h>
+
+#include "rule-days.h"
+
+// Translations
+static const
+gchar *days_plural[] =
+{
+  N_("Sundays"),
+  N_("Mondays"),
+  N_("Tuesdays"),
+  N_("Wednesdays"),
+  N_("Thursdays"),
+  N_("Fridays"),
+  N_("Saturdays")
+};
+
+static const
+gchar *terms_plural[] =
+{
+  N_("Weekdays"),
+  N_("Weekends")
+};
+
+typedef enum
+{
+  TERMS_PLURAL_WEEKDAYS,
+  TERMS_PLURAL_WEEKENDS,
+  TERMS_PLURAL_LAST
+} TermsPlural;
+
+/* Repeat labels of every combination of days; built on first use, as the
+ * locale doesn't change while running
+ */
+static gchar *labels[RULE_DAYS_ALL + 1];
+
+RuleDays
+rule_days_from_array (const bool days[7])
+{
+  RuleDays mask = RULE_DAYS_NONE;
+
+  for (guint day = 0; day < 7; day++)
+    if (days[day])
+      mask |= RULE_DAYS_DAY (day);
+
+  return mask;
+}
+
+void
+rule_days_to_array (RuleDays days,
+                    bool     out[7])
+{
+  for (guint day = 0; day < 7; day++)
+    out[day] = rule_days_has (days, day);
+}
+
+// Bruh, it's 01/01/2025, 00:24 and I'm writing this code
+static gchar *
+rule_days_build_label (RuleDays days)
+{
+  GString *repeated_days = NULL;
+
+  // ...if all days are set;
+  if (days == RULE_DAYS_ALL)
+    return g_strdup (_("Every Day"));
+
+  // ...weekdays
+  if (days == RULE_DAYS_WEEKDAYS)
+    return g_strdup (gettext (terms_plural[TERMS_PLURAL_WEEKDAYS]));
+
+  // ...weekends
+  if (days == RULE_DAYS_WEEKENDS)
+    return g_strdup (gettext (terms_plural[TERMS_PLURAL_WEEKENDS]));
+
+  // ...if any day is set;
+  if (days == RULE_DAYS_NONE)
+    // translators: the rule repeats any day of the week
+    return g_strdup (_("Any Day"));
+
+  // ...if only one or some days are set
+  repeated_days = g_string_new ("");
+  for (guint day = 0; day < 7; day++)
+    {
+      if (!rule_days_has (days, day))
+        continue;
+
+      if (repeated_days->len > 0)
+        g_string_append (repeated_days, ", ");
+
+      g_string_append (repeated_days, gettext (days_plural[day]));
+    }
+
+  return g_string_free (repeated_days, FALSE);
+}
+
+const gchar *
+rule_days_get_label (RuleDays days)
+{
+  days &= RULE_DAYS_ALL;
+
+  if (G_UNLIKELY (labels[days] == NULL))
+    labels[days] = rule_days_build_label (days);
+
+  return labels[days];
+}
@@ -0,0 +1,56 @@
+/* rule-days.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#define ALLOW_MANAGING_RULES
+#include "database-connection/database-connection.h"
+#undef ALLOW_MANAGING_RULES
+
+G_BEGIN_DECLS
+
+/*
+ * The days a rule repeats on, as a 7-bit mask: bit 0 is Sunday, as days[0]
+ * on Rule. The database keeps the bool array, so convert at that boundary.
+ */
+typedef guint8 RuleDays;
+
+#define RULE_DAYS_NONE      ((RuleDays) 0x00)
+#define RULE_DAYS_ALL       ((RuleDays) 0x7F)
+#define RULE_DAYS_WEEKENDS  ((RuleDays) 0x41) // Sunday and Saturday
+#define RULE_DAYS_WEEKDAYS  ((RuleDays) 0x3E)
+
+#define RULE_DAYS_DAY(day)  ((RuleDays) (1 << (day)))
+
+static inline gboolean
+rule_days_has (RuleDays days,
+               guint    day)
+{
+  return (days & RULE_DAYS_DAY (day)) != 0;
+}
+
+RuleDays rule_days_from_array (const bool days[7]);
+void rule_days_to_array (RuleDays days, bool out[7]);
+
+const gchar *rule_days_get_label (RuleDays days);
+
+G_END_DECLS
@@ -21,9 +21,24 @@
 #include <glib/gi18n.h>
 
 #include "rule-face.h"
+#include "database-async.h"
+#include "rule-item.h"
 #include "rule-row.h"
+#include "rule-time-index.h"
+#include "rule-fire-queue.h"
 #include "rule-setup-dialog-edit.h"
 #include "rule-setup-dialog-add.h"
+#include "gawake-timing.h"
+
+/*
+ * Large sets of new rules are added to the list in chunks, from an idle
+ * callback below the redraw priority, so frames keep being drawn meanwhile:
+ * each chunk has at least a screenful of rules, then as many as fit the
+ * budget. The progress bar is only shown for very large tables.
+ */
+#define POPULATE_MIN_CHUNK            32
+#define POPULATE_FRAME_BUDGET_US      (8 * G_TIME_SPAN_MILLISECOND)
+#define POPULATE_PROGRESS_THRESHOLD   1000
 
 struct _RuleFace
 {
@@ -31,14 +46,37 @@ struct _RuleFace
 
   /* Widgets */
   GtkStack            *stack;
+  GtkSpinner          *loading_view;
   AdwStatusPage       *empty_view;
   GtkScrolledWindow   *list_view;
   GtkButton           *action_button;
-  GtkListBox          *list_box;
+  GtkListView         *rule_list;
   AdwToastOverlay     *toast_overlay;
+  GtkActionBar        *selection_bar;
+  GtkLabel            *selection_label;
+  GtkButton           *enable_selected_button;
+  GtkButton           *disable_selected_button;
+  GtkButton           *delete_selected_button;
+  GtkRevealer         *progress_revealer;
+  GtkProgressBar      *progress_bar;
 
   /* Instace variables */
-  guint16              row_count;
+  GListStore          *rules;
+  RuleItem            *edited_item;
+  RuleSetupDialog     *add_dialog;
+  RuleSetupDialog     *edit_dialog;
+  guint                prewarm_source_id;
+  GArray              *pending_rules;
+  guint                pending_position;
+  guint                populate_source_id;
+  RuleTimeIndex       *time_index;
+  RuleFireQueue       *fire_queue;
+  GCancellable        *cancellable;
+  gboolean             loaded;
+  gboolean             refreshing;
+  gboolean             refresh_pending;
+  GtkSelectionModel   *selection;
+  gboolean             selection_mode;
   Table                table;
   RuleFaceType         type;
 };
@@ -53,6 +91,16 @@ enum
 
 static GParamSpec *obj_properties[N_PROPS];
 
+// Signals
+enum
+{
+  SIGNAL_SCHEDULE_CHANGED,
+
+  N_SIGNALS
+};
+
+static guint obj_signals[N_SIGNALS];
+
 G_DEFINE_FINAL_TYPE (RuleFace, rule_face, ADW_TYPE_BIN)
 
 static void
@@ -70,24 +118,72 @@ rule_face_set_list_view (RuleFace *self)
 static void
 rule_face_check_for_empty_view (RuleFace *self)
 {
-  if (self->row_count == 0)
+  if (g_list_model_get_n_items (G_LIST_MODEL (self->rules)) == 0)
     rule_face_set_empty_view (self);
   else
     rule_face_set_list_view (self);
 }
 
+// Keeps the indexes in sync with the model
 static void
-rule_face_delete_rule (RuleRow *row,
-                       guint     _table,
+rule_face_index_rule (RuleFace   *self,
+                      const Rule *rule)
+{
+  rule_time_index_add (self->time_index, rule);
+  rule_fire_queue_add (self->fire_queue, rule);
+}
+
+static void
+rule_face_unindex_rule (RuleFace *self,
+                        guint32   rule_id)
+{
+  rule_time_index_remove (self->time_index, rule_id);
+  rule_fire_queue_remove (self->fire_queue, rule_id);
+}
+
+static void
+rule_face_emit_schedule_changed (RuleFace *self)
+{
+  g_signal_emit (self,
+                 obj_signals[SIGNAL_SCHEDULE_CHANGED],
+                 0);
+}
+
+static void
+rule_face_rules_changed (GListModel *model,
+                         guint       position,
+                         guint       removed,
+                         guint       added,
+                         gpointer    user_data)
+{
+  rule_face_check_for_empty_view (RULE_FACE (user_data));
+}
+
+static void
+rule_face_delete_rule (RuleRow  *row,
+                       RuleItem *item,
                        gpointer  user_data)
 {
   RuleFace *self = RULE_FACE (user_data);
+  guint position;
 
-  gtk_list_box_remove (self->list_box, GTK_WIDGET (row));
-  self->row_count--;
-  rule_face_check_for_empty_view (self);
+  if (g_list_store_find (self->rules, item, &position))
+    g_list_store_remove (self->rules, position);
+
+  rule_face_unindex_rule (self, rule_item_get_rule (item)->id);
+  rule_face_emit_schedule_changed (self);
+}
+
+static void
+rule_face_toggle_rule (RuleRow  *row,
+                       RuleItem *item,
+                       gpointer  user_data)
+{
+  RuleFace *self = RULE_FACE (user_data);
 
-  g_clear_object (&row);
+  // Enabling or disabling a rule only matters for the upcoming one
+  rule_fire_queue_add (self->fire_queue, rule_item_get_rule (item));
+  rule_face_emit_schedule_changed (self);
 }
 
 static void
@@ -100,24 +196,148 @@ rule_face_show_error_for_row (RuleRow     *row,
   adw_toast_overlay_add_toast (self->toast_overlay, adw_toast_new (error));
 }
 
+// Factory: rows are only created for the visible items, and then recycled
 static void
-rule_face_append_rule (RuleFace *self,
-                       guint16   rule_id)
+rule_face_setup_row (GtkSignalListItemFactory *factory,
+                     GtkListItem              *list_item,
+                     gpointer                  user_data)
 {
-  RuleRow *row = rule_row_new (self->table, rule_id);
+  RuleFace *self = RULE_FACE (user_data);
+  RuleRow *row = rule_row_new ();
+
+  // Rows may outlive the face while an operation is pending
+  g_signal_connect_object (row,
+                           "rule-deleted",
+                           G_CALLBACK (rule_face_delete_rule),
+                           self,
+                           0);
+
+  g_signal_connect_object (row,
+                           "rule-toggled",
+                           G_CALLBACK (rule_face_toggle_rule),
+                           self,
+                           0);
+
+  g_signal_connect_object (row,
+                           "error",
+                           G_CALLBACK (rule_face_show_error_for_row),
+                           self,
+                           0);
+
+  gtk_list_item_set_child (list_item, GTK_WIDGET (row));
+}
 
-  g_signal_connect (row,
-                    "rule-deleted",
-                    G_CALLBACK (rule_face_delete_rule),
-                    self);
+static void
+rule_face_bind_row (GtkSignalListItemFactory *factory,
+                    GtkListItem              *list_item,
+                    gpointer                  user_data)
+{
+  rule_row_bind (RULE_ROW (gtk_list_item_get_child (list_item)),
+                 RULE_ITEM (gtk_list_item_get_item (list_item)));
+}
 
-  g_signal_connect (row,
-                    "error",
-                    G_CALLBACK (rule_face_show_error_for_row),
-                    self);
+static void
+rule_face_unbind_row (GtkSignalListItemFactory *factory,
+                      GtkListItem              *list_item,
+                      gpointer                  user_data)
+{
+  rule_row_unbind (RULE_ROW (gtk_list_item_get_child (list_item)));
+}
 
-  gtk_list_box_append (self->list_box, GTK_WIDGET (row));
-  self->row_count++;
+// Finds the item of <rule_id>; from the end, where new rules are
+static gboolean
+rule_face_find_rule (RuleFace *self,
+                     guint32   rule_id,
+                     guint    *position)
+{
+  GListModel *model = G_LIST_MODEL (self->rules);
+
+  for (guint i = g_list_model_get_n_items (model); i > 0; i--)
+    {
+      g_autoptr (RuleItem) item = g_list_model_get_item (model, i - 1);
+
+      if (rule_item_get_rule (item)->id == rule_id)
+        {
+          *position = i - 1;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+// Updates <rule> if it's waiting to be added to the list
+static gboolean
+rule_face_update_pending_rule (RuleFace   *self,
+                               const Rule *rule)
+{
+  if (self->pending_rules == NULL)
+    return FALSE;
+
+  for (guint i = self->pending_position; i < self->pending_rules->len; i++)
+    {
+      if (g_array_index (self->pending_rules, Rule, i).id == rule->id)
+        {
+          g_array_index (self->pending_rules, Rule, i) = *rule;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/*
+ * Adds a rule that was just created; a refresh (e.g. triggered by the
+ * database monitor) may have added it first, then it's updated instead
+ */
+static void
+rule_face_append_rule (RuleFace   *self,
+                       const Rule *rule)
+{
+  g_autoptr (RuleItem) item = rule_item_new (rule);
+  guint position;
+
+  if (rule_face_find_rule (self, rule->id, &position))
+    g_list_store_splice (self->rules, position, 1, (gpointer *) &item, 1);
+  else if (!rule_face_update_pending_rule (self, rule))
+    g_list_store_append (self->rules, item);
+
+  rule_face_index_rule (self, rule);
+  rule_face_emit_schedule_changed (self);
+}
+
+static void
+rule_face_edit_rule_ready (GObject      *source_object,
+                           GAsyncResult *result,
+                           gpointer      user_data)
+{
+  g_autoptr (RuleItem) item = RULE_ITEM (user_data);
+  g_autoptr (GError) error = NULL;
+  RuleFace *self = NULL;
+  guint position;
+  Rule rule;
+
+  if (!database_async_rule_get_single_finish (result, &rule, &error))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+      self = RULE_FACE (source_object);
+      adw_toast_overlay_add_toast (self->toast_overlay, adw_toast_new (_("Failed to update rule")));
+      return;
+    }
+
+  self = RULE_FACE (source_object);
+
+  if (g_list_store_find (self->rules, item, &position))
+    {
+      g_autoptr (RuleItem) updated = rule_item_new (&rule);
+
+      // Replacing the item makes the list view rebind its row
+      g_list_store_splice (self->rules, position, 1, (gpointer *) &updated, 1);
+      rule_face_index_rule (self, &rule);
+      rule_face_emit_schedule_changed (self);
+    }
 }
 
 static void
@@ -127,14 +347,43 @@ rule_face_edit_rule (RuleSetupDialog *dialog,
                      guint            _rule_id,
                      gpointer         user_data)
 {
-  RuleRow *row = RULE_ROW (user_data);
+  RuleFace *self = RULE_FACE (user_data);
+  guint32 rule_id = _rule_id;
 
-  if (!cancelled)
-    rule_row_update_fields (row);
+  if (!cancelled && self->edited_item != NULL)
+    database_async_rule_get_single (self,
+                                    rule_id,
+                                    self->table,
+                                    self->cancellable,
+                                    rule_face_edit_rule_ready,
+                                    g_steal_pointer (&self->edited_item));
 
+  g_clear_object (&self->edited_item);
   rule_setup_dialog_finish (dialog);
 }
 
+static void
+rule_face_add_rule_ready (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+  RuleFace *self = NULL;
+  Rule rule;
+
+  if (!database_async_rule_get_single_finish (result, &rule, &error))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+      self = RULE_FACE (source_object);
+      adw_toast_overlay_add_toast (self->toast_overlay, adw_toast_new (_("Failed to get rule")));
+      return;
+    }
+
+  rule_face_append_rule (RULE_FACE (source_object), &rule);
+}
+
 static void
 rule_face_add_rule (RuleSetupDialog *dialog,
                     gboolean         cancelled,
@@ -143,45 +392,98 @@ rule_face_add_rule (RuleSetupDialog *dialog,
                     gpointer         user_data)
 {
   RuleFace *self = RULE_FACE (user_data);
-  guint16 rule_id = (guint16) _rule_id;
+  guint32 rule_id = _rule_id;
 
   if (!cancelled)
-    {
-      rule_face_append_rule (self, rule_id);
-      rule_face_check_for_empty_view (self);
-    }
+    database_async_rule_get_single (self,
+                                    rule_id,
+                                    self->table,
+                                    self->cancellable,
+                                    rule_face_add_rule_ready,
+                                    NULL);
 
   rule_setup_dialog_finish (dialog);
 }
 
+/*
+ * Each face keeps one add and one edit dialog alive, created on first use
+ * (or once the rules are loaded, see rule_face_prewarm_dialogs()) and bound
+ * to a rule every time they're opened
+ */
+static RuleSetupDialog *
+rule_face_get_dialog (RuleFace *self,
+                      gboolean  edit)
+{
+  RuleSetupDialog **dialog = edit ? &self->edit_dialog : &self->add_dialog;
+
+  if (*dialog != NULL)
+    return *dialog;
+
+  if (edit)
+    *dialog = RULE_SETUP_DIALOG (rule_setup_dialog_edit_new (self->table));
+  else
+    *dialog = RULE_SETUP_DIALOG (rule_setup_dialog_add_new (self->table));
+
+  // Windows are owned by GTK; keep them around while hidden
+  g_object_ref (*dialog);
+  rule_setup_dialog_set_time_index (*dialog, self->time_index);
+
+  g_signal_connect (*dialog,
+                    "done",
+                    edit ? G_CALLBACK (rule_face_edit_rule) : G_CALLBACK (rule_face_add_rule),
+                    self);
+
+  return *dialog;
+}
+
 static void
-rule_face_list_box_row_activated (GtkListBox    *list_box,
-                                  GtkListBoxRow *row,
-                                  gpointer       user_data)
+rule_face_present_dialog (RuleFace        *self,
+                          RuleSetupDialog *dialog)
+{
+  GtkRoot *root = gtk_widget_get_root (GTK_WIDGET (self));
+
+  if (GTK_IS_WINDOW (root))
+    gtk_window_set_transient_for (GTK_WINDOW (dialog), GTK_WINDOW (root));
+
+  gtk_window_present (GTK_WINDOW (dialog));
+}
+
+static gboolean
+rule_face_prewarm_dialogs (gpointer user_data)
 {
   RuleFace *self = RULE_FACE (user_data);
-  GtkWidget *parent = GTK_WIDGET (self);
-  guint16 rule_id = rule_row_get_id (RULE_ROW (row));
-  GtkWindow *dialog = NULL;
 
-  dialog = GTK_WINDOW (rule_setup_dialog_edit_new (self->table, rule_id));
+  self->prewarm_source_id = 0;
+  rule_face_get_dialog (self, TRUE);
+  rule_face_get_dialog (self, FALSE);
 
-  g_signal_connect (dialog,
-                    "done",
-                    G_CALLBACK (rule_face_edit_rule),
-                    RULE_ROW (row));
+  return G_SOURCE_REMOVE;
+}
 
-  while ((parent = gtk_widget_get_parent (parent)) != NULL)
-    {
-      g_debug ("Parent widget: %s", G_OBJECT_TYPE_NAME (parent));
-      if (GTK_IS_WINDOW (parent))
-        {
-          gtk_window_set_transient_for (dialog, GTK_WINDOW (parent));
-          break;
-        }
-    }
+static void
+rule_face_rule_list_activated (GtkListView *list_view,
+                               guint        position,
+                               gpointer     user_data)
+{
+  RuleFace *self = RULE_FACE (user_data);
+  g_autoptr (RuleItem) item = NULL;
+  RuleSetupDialog *dialog = NULL;
+
+  // Clicks select rules in selection mode
+  if (self->selection_mode)
+    return;
+
+  item = g_list_model_get_item (G_LIST_MODEL (self->rules), position);
+  if (item == NULL)
+    return;
+
+  dialog = rule_face_get_dialog (self, TRUE);
+  rule_setup_dialog_set_rule (dialog, rule_item_get_rule (item));
+
+  // The dialog is modal, so only one rule is edited at a time
+  g_set_object (&self->edited_item, item);
 
-  gtk_window_present (dialog);
+  rule_face_present_dialog (self, dialog);
 }
 
 static void
@@ -195,45 +497,449 @@ rule_face_action_button_clicked (GtkButton *self,
 void
 rule_face_open_setup_add_dialog (RuleFace *self)
 {
-  GtkWindow *dialog = NULL;
-  GtkWidget *parent = GTK_WIDGET (self);
+  RuleSetupDialog *dialog = rule_face_get_dialog (self, FALSE);
 
-  dialog = GTK_WINDOW (rule_setup_dialog_add_new (self->table));
+  rule_setup_dialog_set_rule (dialog, NULL);
+  rule_face_present_dialog (self, dialog);
+}
 
-  g_signal_connect (dialog,
-                    "done",
-                    G_CALLBACK (rule_face_add_rule),
-                    self);
+// Adds the next chunk of the pending rules to the list
+static gboolean
+rule_face_populate_chunk (gpointer user_data)
+{
+  RuleFace *self = RULE_FACE (user_data);
+  g_autoptr (GPtrArray) items = NULL;
+  gint64 deadline = g_get_monotonic_time () + POPULATE_FRAME_BUDGET_US;
+
+  items = g_ptr_array_new_with_free_func (g_object_unref);
+
+  while (self->pending_position < self->pending_rules->len
+         && (items->len < POPULATE_MIN_CHUNK || g_get_monotonic_time () < deadline))
+    {
+      g_ptr_array_add (items, rule_item_new (&g_array_index (self->pending_rules,
+                                                             Rule,
+                                                             self->pending_position)));
+      self->pending_position++;
+    }
+
+  g_list_store_splice (self->rules,
+                       g_list_model_get_n_items (G_LIST_MODEL (self->rules)),
+                       0,
+                       items->pdata,
+                       items->len);
+
+  if (self->pending_position < self->pending_rules->len)
+    {
+      gtk_progress_bar_set_fraction (self->progress_bar,
+                                     (gdouble) self->pending_position / self->pending_rules->len);
+      return G_SOURCE_CONTINUE;
+    }
+
+  // Done
+  self->populate_source_id = 0;
+  g_clear_pointer (&self->pending_rules, g_array_unref);
+  gtk_revealer_set_reveal_child (self->progress_revealer, FALSE);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Drops the rules not added to the list yet (e.g. the table is being read
+ * again); they were indexed already, so they are unindexed too.
+ */
+static void
+rule_face_cancel_population (RuleFace *self)
+{
+  if (self->pending_rules == NULL)
+    return;
+
+  g_clear_handle_id (&self->populate_source_id, g_source_remove);
+
+  for (guint i = self->pending_position; i < self->pending_rules->len; i++)
+    rule_face_unindex_rule (self, g_array_index (self->pending_rules, Rule, i).id);
 
-  while ((parent = gtk_widget_get_parent (parent)) != NULL)
+  g_clear_pointer (&self->pending_rules, g_array_unref);
+  gtk_revealer_set_reveal_child (self->progress_revealer, FALSE);
+}
+
+/*
+ * Appends <rules> to the list: the first chunk right away (all of them, if
+ * they are a few), the rest progressively.
+ */
+static void
+rule_face_populate (RuleFace *self,
+                    GArray   *rules)
+{
+  self->pending_rules = g_array_ref (rules);
+  self->pending_position = 0;
+
+  if (!rule_face_populate_chunk (self))
+    return;
+
+  if (rules->len >= POPULATE_PROGRESS_THRESHOLD)
     {
-      g_debug ("Parent widget: %s", G_OBJECT_TYPE_NAME (parent));
-      if (GTK_IS_WINDOW (parent))
+      gtk_progress_bar_set_fraction (self->progress_bar,
+                                     (gdouble) self->pending_position / rules->len);
+      gtk_revealer_set_reveal_child (self->progress_revealer, TRUE);
+    }
+
+  self->populate_source_id = g_idle_add_full (GDK_PRIORITY_REDRAW + 10,
+                                              rule_face_populate_chunk,
+                                              self,
+                                              NULL);
+}
+
+/*
+ * Applies the rules read from the database as a delta over the model: new
+ * rules are appended (progressively, see rule_face_populate ()), changed ones
+ * replaced, and the ones that are gone removed. Unchanged items (and their
+ * rows) are kept.
+ */
+static void
+rule_face_apply_rules (RuleFace   *self,
+                       const Rule *rules,
+                       guint32     row_count)
+{
+  GListModel *model = G_LIST_MODEL (self->rules);
+  g_autoptr (GHashTable) fetched = NULL;
+  g_autoptr (GArray) added = NULL;
+
+  // The delta is against the list: the rules still pending count as new
+  rule_face_cancel_population (self);
+
+  // A full load: drop anything left on the shared index, e.g. by a previous window
+  if (g_list_model_get_n_items (model) == 0)
+    rule_time_index_clear (self->time_index);
+
+  // id -> fetched rule
+  fetched = g_hash_table_new (NULL, NULL);
+  for (guint32 row_idx = 0; row_idx < row_count; row_idx++)
+    g_hash_table_insert (fetched,
+                         GUINT_TO_POINTER (rules[row_idx].id),
+                         (gpointer) &rules[row_idx]);
+
+  // Updates and removals; from the end, so the positions stay valid
+  for (guint position = g_list_model_get_n_items (model); position > 0; position--)
+    {
+      g_autoptr (RuleItem) item = g_list_model_get_item (model, position - 1);
+      guint32 rule_id = rule_item_get_rule (item)->id;
+      const Rule *rule = g_hash_table_lookup (fetched, GUINT_TO_POINTER (rule_id));
+
+      if (rule == NULL)
         {
-          gtk_window_set_transient_for (dialog, GTK_WINDOW (parent));
-          break;
+          rule_face_unindex_rule (self, rule_id);
+          g_list_store_remove (self->rules, position - 1);
+          continue;
         }
+
+      if (!rule_item_equal (item, rule))
+        {
+          g_autoptr (RuleItem) updated = rule_item_new (rule);
+
+          g_list_store_splice (self->rules, position - 1, 1, (gpointer *) &updated, 1);
+          rule_face_index_rule (self, rule);
+        }
+
+      // What's left on <fetched> are the new rules
+      g_hash_table_remove (fetched, GUINT_TO_POINTER (rule_id));
     }
 
-  gtk_window_present (dialog);
+  // Insertions, keeping the database order; all of them indexed right away
+  added = g_array_sized_new (FALSE, FALSE, sizeof (Rule), g_hash_table_size (fetched));
+  for (guint32 row_idx = 0; row_idx < row_count; row_idx++)
+    {
+      if (!g_hash_table_contains (fetched, GUINT_TO_POINTER (rules[row_idx].id)))
+        continue;
+
+      g_array_append_val (added, rules[row_idx]);
+      rule_face_index_rule (self, &rules[row_idx]);
+    }
+
+  if (added->len > 0)
+    rule_face_populate (self, added);
 }
 
 static void
-rule_face_populate_rules (RuleFace *self)
+rule_face_refresh_ready (GObject      *source_object,
+                         GAsyncResult *result,
+                         gpointer      user_data)
 {
+  g_autoptr (GError) error = NULL;
+  RuleFace *self = NULL;
   Rule *rules = NULL;
-  guint16 row_count = 0;
+  guint32 row_count = 0;
 
-  if (rule_get_all (self->table, &rules, &row_count) == EXIT_FAILURE)
+  if (!database_async_rule_get_all_finish (result, &rules, &row_count, &error))
     {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+      self = RULE_FACE (source_object);
+      self->refreshing = FALSE;
+
+      // Not retried right away: the next change (or page switch) reads again
+      self->refresh_pending = FALSE;
+
+      if (!self->loaded)
+        gawake_timing_end (self->table == TABLE_ON ? "populate-rules-on" : "populate-rules-off");
+      self->loaded = TRUE;
+
       adw_toast_overlay_add_toast (self->toast_overlay, adw_toast_new (_("Failed to get rules")));
+      rule_face_check_for_empty_view (self);
+      rule_face_emit_schedule_changed (self);
       return;
     }
 
-  for (guint16 row_idx = 0; row_idx < row_count; row_idx++)
-    rule_face_append_rule (self, rules[row_idx].id);
+  self = RULE_FACE (source_object);
+  self->refreshing = FALSE;
+
+  if (!self->loaded)
+    {
+      gawake_timing_end (self->table == TABLE_ON ? "populate-rules-on" : "populate-rules-off");
+
+      // Have the dialogs ready before the user reaches for them
+      self->prewarm_source_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                 rule_face_prewarm_dialogs,
+                                                 self,
+                                                 NULL);
+    }
+  self->loaded = TRUE;
+
+  rule_face_apply_rules (self, rules, row_count);
+  rule_face_emit_schedule_changed (self);
+
+  // Required if the table is empty, as no "items-changed" is emitted
+  rule_face_check_for_empty_view (self);
 
   free (rules);
+
+  // Changes were notified while reading: read again
+  if (self->refresh_pending)
+    rule_face_refresh (self);
+}
+
+/*
+ * Synchronizes the face with the database, e.g. after changes made outside
+ * the UI; only the rules that changed are touched.
+ */
+void
+rule_face_refresh (RuleFace *self)
+{
+  g_return_if_fail (RULE_IS_FACE (self));
+
+  if (self->refreshing)
+    {
+      self->refresh_pending = TRUE;
+      return;
+    }
+
+  self->refreshing = TRUE;
+  self->refresh_pending = FALSE;
+
+  database_async_rule_get_all (self,
+                               self->table,
+                               self->cancellable,
+                               rule_face_refresh_ready,
+                               NULL);
+}
+
+// Whether the first read of the rules is done, even if it failed
+gboolean
+rule_face_get_loaded (RuleFace *self)
+{
+  g_return_val_if_fail (RULE_IS_FACE (self), FALSE);
+
+  return self->loaded;
+}
+
+/*
+ * Gets the active rule that fires next, and when (<fire_time> is owned by the
+ * caller). Returns FALSE if there's none, or the rules aren't loaded yet.
+ */
+gboolean
+rule_face_get_upcoming_rule (RuleFace   *self,
+                             Rule       *rule,
+                             GDateTime **fire_time)
+{
+  g_autoptr (GDateTime) now = NULL;
+
+  g_return_val_if_fail (RULE_IS_FACE (self), FALSE);
+
+  if (!self->loaded)
+    return FALSE;
+
+  now = g_date_time_new_now_local ();
+
+  return rule_fire_queue_peek (self->fire_queue, now, rule, fire_time);
+}
+
+// SELECTION MODE
+static void
+rule_face_selection_changed (GtkSelectionModel *model,
+                             guint              position,
+                             guint              n_items,
+                             gpointer           user_data)
+{
+  RuleFace *self = RULE_FACE (user_data);
+  g_autoptr (GtkBitset) selected = NULL;
+  g_autofree gchar *text = NULL;
+  guint count;
+
+  selected = gtk_selection_model_get_selection (self->selection);
+  count = (guint) gtk_bitset_get_size (selected);
+
+  // translators: number of selected rules
+  text = g_strdup_printf (ngettext ("%u rule selected",
+                                    "%u rules selected",
+                                    count),
+                          count);
+  gtk_label_set_text (self->selection_label, text);
+
+  gtk_widget_set_sensitive (GTK_WIDGET (self->enable_selected_button), count > 0);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->disable_selected_button), count > 0);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->delete_selected_button), count > 0);
+}
+
+// Rules can be selected (for batch operations) only in selection mode
+static void
+rule_face_set_list_model (RuleFace *self)
+{
+  if (self->selection != NULL)
+    g_signal_handlers_disconnect_by_func (self->selection,
+                                          rule_face_selection_changed,
+                                          self);
+
+  g_clear_object (&self->selection);
+
+  if (self->selection_mode)
+    self->selection = GTK_SELECTION_MODEL (gtk_multi_selection_new (G_LIST_MODEL (g_object_ref (self->rules))));
+  else
+    self->selection = GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (g_object_ref (self->rules))));
+
+  g_signal_connect (self->selection,
+                    "selection-changed",
+                    G_CALLBACK (rule_face_selection_changed),
+                    self);
+
+  gtk_list_view_set_model (self->rule_list, self->selection);
+}
+
+void
+rule_face_set_selection_mode (RuleFace *self,
+                              gboolean  selection_mode)
+{
+  g_return_if_fail (RULE_IS_FACE (self));
+
+  selection_mode = !!selection_mode;
+  if (self->selection_mode == selection_mode)
+    return;
+
+  self->selection_mode = selection_mode;
+
+  // Hovering would select rules otherwise
+  gtk_list_view_set_single_click_activate (self->rule_list, !selection_mode);
+  gtk_list_view_set_enable_rubberband (self->rule_list, selection_mode);
+
+  rule_face_set_list_model (self);
+  rule_face_selection_changed (self->selection, 0, 0, self);
+
+  gtk_action_bar_set_revealed (self->selection_bar, selection_mode);
+}
+
+static void
+rule_face_batch_ready (GObject      *source_object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+  RuleFace *self = NULL;
+
+  if (!database_async_rule_batch_finish (result, &error)
+      && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = RULE_FACE (source_object);
+
+  // Some of the rules may have been changed anyway
+  if (error != NULL)
+    adw_toast_overlay_add_toast (self->toast_overlay,
+                                 adw_toast_new (_("Failed to change some of the rules")));
+
+  gtk_widget_set_sensitive (GTK_WIDGET (self->selection_bar), TRUE);
+
+  // A single delta refresh for the whole set
+  rule_face_refresh (self);
+}
+
+static void
+rule_face_run_batch (RuleFace            *self,
+                     DatabaseBatchAction  action)
+{
+  g_autoptr (GtkBitset) selected = NULL;
+  g_autoptr (GArray) rule_ids = NULL;
+  GtkBitsetIter iter;
+  guint position;
+
+  selected = gtk_selection_model_get_selection (self->selection);
+  if (gtk_bitset_is_empty (selected))
+    return;
+
+  rule_ids = g_array_sized_new (FALSE, FALSE, sizeof (guint32), gtk_bitset_get_size (selected));
+
+  for (gboolean valid = gtk_bitset_iter_init_first (&iter, selected, &position);
+       valid;
+       valid = gtk_bitset_iter_next (&iter, &position))
+    {
+      g_autoptr (RuleItem) item = g_list_model_get_item (G_LIST_MODEL (self->rules), position);
+      guint32 rule_id = rule_item_get_rule (item)->id;
+
+      g_array_append_val (rule_ids, rule_id);
+    }
+
+  gtk_selection_model_unselect_all (self->selection);
+
+  // Until the batch is done
+  gtk_widget_set_sensitive (GTK_WIDGET (self->selection_bar), FALSE);
+
+  database_async_rule_batch (self,
+                             action,
+                             self->table,
+                             rule_ids,
+                             self->cancellable,
+                             rule_face_batch_ready,
+                             NULL);
+}
+
+static void
+rule_face_enable_selected_clicked (GtkButton *button,
+                                   gpointer   user_data)
+{
+  rule_face_run_batch (RULE_FACE (user_data), DATABASE_BATCH_ACTION_ENABLE);
+}
+
+static void
+rule_face_disable_selected_clicked (GtkButton *button,
+                                    gpointer   user_data)
+{
+  rule_face_run_batch (RULE_FACE (user_data), DATABASE_BATCH_ACTION_DISABLE);
+}
+
+static void
+rule_face_delete_selected_clicked (GtkButton *button,
+                                   gpointer   user_data)
+{
+  rule_face_run_batch (RULE_FACE (user_data), DATABASE_BATCH_ACTION_DELETE);
+}
+
+static void
+rule_face_populate_rules (RuleFace *self)
+{
+  // Show a spinner while loading
+  gtk_stack_set_visible_child (self->stack, GTK_WIDGET (self->loading_view));
+
+  gawake_timing_begin (self->table == TABLE_ON ? "populate-rules-on" : "populate-rules-off");
+
+  rule_face_refresh (self);
 }
 
 static void
@@ -242,6 +948,9 @@ rule_face_constructed (GObject *gobject)
   RuleFace *self = RULE_FACE (gobject);
   G_OBJECT_CLASS (rule_face_parent_class)->constructed (gobject);
 
+  // Shared with the setup dialogs of both tables, see rule-time-index.c
+  self->time_index = rule_time_index_ref (rule_time_index_get_default (self->table));
+
   // Set empty view icon
   switch (self->type)
     {
@@ -260,8 +969,6 @@ rule_face_constructed (GObject *gobject)
 
   // Populate rules
   rule_face_populate_rules (self);
-
-  rule_face_check_for_empty_view (self);
 }
 
 static void
@@ -287,6 +994,29 @@ rule_face_set_property (GObject      *object,
 static void
 rule_face_dispose (GObject *gobject)
 {
+  RuleFace *self = RULE_FACE (gobject);
+
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+  if (self->selection != NULL)
+    g_signal_handlers_disconnect_by_func (self->selection,
+                                          rule_face_selection_changed,
+                                          self);
+  g_clear_object (&self->selection);
+  g_clear_object (&self->rules);
+  g_clear_object (&self->edited_item);
+  g_clear_handle_id (&self->prewarm_source_id, g_source_remove);
+  g_clear_handle_id (&self->populate_source_id, g_source_remove);
+  g_clear_pointer (&self->pending_rules, g_array_unref);
+  if (self->add_dialog != NULL)
+    gtk_window_destroy (GTK_WINDOW (self->add_dialog));
+  if (self->edit_dialog != NULL)
+    gtk_window_destroy (GTK_WINDOW (self->edit_dialog));
+  g_clear_object (&self->add_dialog);
+  g_clear_object (&self->edit_dialog);
+  g_clear_pointer (&self->time_index, rule_time_index_unref);
+  g_clear_pointer (&self->fire_queue, rule_fire_queue_unref);
+
   gtk_widget_dispose_template (GTK_WIDGET (gobject), RULE_TYPE_FACE);
 
   G_OBJECT_CLASS (rule_face_parent_class)->dispose (gobject);
@@ -302,11 +1032,19 @@ rule_face_class_init (RuleFaceClass *klass)
 
   // Widgets
   gtk_widget_class_bind_template_child (widget_class, RuleFace, stack);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, loading_view);
   gtk_widget_class_bind_template_child (widget_class, RuleFace, empty_view);
   gtk_widget_class_bind_template_child (widget_class, RuleFace, action_button);
-  gtk_widget_class_bind_template_child (widget_class, RuleFace, list_box);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, rule_list);
   gtk_widget_class_bind_template_child (widget_class, RuleFace, list_view);
   gtk_widget_class_bind_template_child (widget_class, RuleFace, toast_overlay);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, selection_bar);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, selection_label);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, enable_selected_button);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, disable_selected_button);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, delete_selected_button);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, progress_revealer);
+  gtk_widget_class_bind_template_child (widget_class, RuleFace, progress_bar);
 
   // Properties
   obj_properties[PROP_TYPE] =
@@ -324,6 +1062,17 @@ rule_face_class_init (RuleFaceClass *klass)
                                      N_PROPS,
                                      obj_properties);
 
+  // Signals
+  obj_signals[SIGNAL_SCHEDULE_CHANGED] =
+    g_signal_new ("schedule-changed",
+                  RULE_TYPE_FACE,
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE,            // no return value
+                  0);                     // 0 arguments
+
   // Constructor
   G_OBJECT_CLASS (klass)->constructed = rule_face_constructed;
 
@@ -333,20 +1082,68 @@ rule_face_class_init (RuleFaceClass *klass)
 static void
 rule_face_init (RuleFace *self)
 {
-  self->row_count = 0;
+  GtkListItemFactory *factory = NULL;
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  // Model
+  self->rules = g_list_store_new (RULE_TYPE_ITEM);
+  self->edited_item = NULL;
+  self->add_dialog = NULL;
+  self->edit_dialog = NULL;
+  self->prewarm_source_id = 0;
+  self->pending_rules = NULL;
+  self->pending_position = 0;
+  self->populate_source_id = 0;
+  self->time_index = NULL;
+  self->fire_queue = rule_fire_queue_new ();
+  self->cancellable = g_cancellable_new ();
+  self->loaded = FALSE;
+  self->refreshing = FALSE;
+  self->refresh_pending = FALSE;
+  self->selection = NULL;
+  self->selection_mode = FALSE;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (rule_face_setup_row), self);
+  g_signal_connect (factory, "bind", G_CALLBACK (rule_face_bind_row), self);
+  g_signal_connect (factory, "unbind", G_CALLBACK (rule_face_unbind_row), self);
+
+  // The list view keeps its own reference to the factory
+  rule_face_set_list_model (self);
+  gtk_list_view_set_factory (self->rule_list, factory);
+  g_object_unref (factory);
+
   // Signals
-  g_signal_connect (self->list_box,
-                    "row-activated",
-                    G_CALLBACK (rule_face_list_box_row_activated),
+  g_signal_connect (self->rules,
+                    "items-changed",
+                    G_CALLBACK (rule_face_rules_changed),
+                    self);
+
+  g_signal_connect (self->rule_list,
+                    "activate",
+                    G_CALLBACK (rule_face_rule_list_activated),
                     self);
 
   g_signal_connect (self->action_button,
                     "clicked",
                     G_CALLBACK (rule_face_action_button_clicked),
                     self);
+
+  g_signal_connect (self->enable_selected_button,
+                    "clicked",
+                    G_CALLBACK (rule_face_enable_selected_clicked),
+                    self);
+
+  g_signal_connect (self->disable_selected_button,
+                    "clicked",
+                    G_CALLBACK (rule_face_disable_selected_clicked),
+                    self);
+
+  g_signal_connect (self->delete_selected_button,
+                    "clicked",
+                    G_CALLBACK (rule_face_delete_selected_clicked),
+                    self);
 }
 
 RuleFace *
@@ -43,6 +43,12 @@ G_DECLARE_FINAL_TYPE (RuleFace, rule_face, RULE, FACE, AdwBin)
 
 RuleFace *rule_face_new (RuleFaceType type);
 void rule_face_open_setup_add_dialog (RuleFace *self);
+void rule_face_refresh (RuleFace *self);
+void rule_face_set_selection_mode (RuleFace *self, gboolean selection_mode);
+gboolean rule_face_get_loaded (RuleFace *self);
+gboolean rule_face_get_upcoming_rule (RuleFace   *self,
+                                      Rule       *rule,
+                                      GDateTime **fire_time);
 
 G_END_DECLS
 
@@ -0,0 +1,334 @@
+/* rule-fire-queue.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Priority queue of the active rules of a table, ordered by their next
+ * occurrence, so the upcoming rule is found without scanning every rule.
+ *
+ * The queue is a binary min-heap. Entries are never updated in place: adding
+ * a rule again (edited, toggled) bumps its generation and pushes a new entry,
+ * and removing it only drops it from <rules>; outdated entries are discarded
+ * when they reach the top. Entries whose time has passed are re-keyed to the
+ * following occurrence lazily, on rule_fire_queue_peek ().
+ */
+
+#include "rule-fire-queue.h"
+#include "rule-days.h"
+
+// Rebuild the heap when outdated entries outnumber the live ones by this much
+#define COMPACT_THRESHOLD 32
+
+typedef struct
+{
+  gint64                fire_time;        // Unix time of the next occurrence
+  guint32               rule_id;
+  guint                 generation;
+} HeapEntry;
+
+typedef struct
+{
+  Rule                  rule;
+  guint                 generation;
+} QueuedRule;
+
+struct _RuleFireQueue
+{
+  gatomicrefcount       ref_count;
+
+  GArray               *heap;             // of HeapEntry
+  GHashTable           *rules;            // id -> QueuedRule
+  guint                 next_generation;
+};
+
+// Next time <rule> fires after <now>; -1 if it is never repeated
+static gint64
+rule_fire_queue_next_occurrence (const Rule *rule,
+                                 GDateTime  *now)
+{
+  g_autoptr (GDateTime) today = NULL;
+  gint64 now_unix = g_date_time_to_unix (now);
+  guint weekday = g_date_time_get_day_of_week (now) % 7; // days[0] is Sunday
+  RuleDays days = rule_days_from_array (rule->days);
+
+  if (days == RULE_DAYS_NONE)
+    return -1;
+
+  today = g_date_time_new_local (g_date_time_get_year (now),
+                                 g_date_time_get_month (now),
+                                 g_date_time_get_day_of_month (now),
+                                 rule->hour,
+                                 rule->minutes,
+                                 0);
+  if (today == NULL)
+    return -1;
+
+  // Up to a week ahead: today's time may have passed already
+  for (guint offset = 0; offset <= 7; offset++)
+    {
+      g_autoptr (GDateTime) candidate = NULL;
+      gint64 candidate_unix;
+
+      if (!rule_days_has (days, (weekday + offset) % 7))
+        continue;
+
+      candidate = g_date_time_add_days (today, offset);
+      candidate_unix = g_date_time_to_unix (candidate);
+
+      if (candidate_unix > now_unix)
+        return candidate_unix;
+    }
+
+  return -1;
+}
+
+static void
+rule_fire_queue_sift_up (GArray *heap,
+                         guint   position)
+{
+  HeapEntry entry = g_array_index (heap, HeapEntry, position);
+
+  while (position > 0)
+    {
+      guint parent = (position - 1) / 2;
+
+      if (g_array_index (heap, HeapEntry, parent).fire_time <= entry.fire_time)
+        break;
+
+      g_array_index (heap, HeapEntry, position) = g_array_index (heap, HeapEntry, parent);
+      position = parent;
+    }
+
+  g_array_index (heap, HeapEntry, position) = entry;
+}
+
+static void
+rule_fire_queue_sift_down (GArray *heap,
+                           guint   position)
+{
+  HeapEntry entry = g_array_index (heap, HeapEntry, position);
+
+  for (;;)
+    {
+      guint child = 2 * position + 1;
+
+      if (child >= heap->len)
+        break;
+
+      if (child + 1 < heap->len
+          && g_array_index (heap, HeapEntry, child + 1).fire_time < g_array_index (heap, HeapEntry, child).fire_time)
+        child++;
+
+      if (entry.fire_time <= g_array_index (heap, HeapEntry, child).fire_time)
+        break;
+
+      g_array_index (heap, HeapEntry, position) = g_array_index (heap, HeapEntry, child);
+      position = child;
+    }
+
+  g_array_index (heap, HeapEntry, position) = entry;
+}
+
+static void
+rule_fire_queue_push (RuleFireQueue *self,
+                      QueuedRule    *queued,
+                      GDateTime     *now)
+{
+  HeapEntry entry;
+
+  entry.fire_time = rule_fire_queue_next_occurrence (&queued->rule, now);
+  if (entry.fire_time < 0)
+    return;
+
+  entry.rule_id = queued->rule.id;
+  entry.generation = queued->generation;
+
+  g_array_append_val (self->heap, entry);
+  rule_fire_queue_sift_up (self->heap, self->heap->len - 1);
+}
+
+static void
+rule_fire_queue_pop (RuleFireQueue *self)
+{
+  g_array_remove_index_fast (self->heap, 0);
+
+  if (self->heap->len > 0)
+    rule_fire_queue_sift_down (self->heap, 0);
+}
+
+// Drops the outdated entries, rebuilding the heap from the live rules
+static void
+rule_fire_queue_compact (RuleFireQueue *self)
+{
+  g_autoptr (GDateTime) now = g_date_time_new_now_local ();
+  GHashTableIter iter;
+  gpointer value;
+
+  g_array_set_size (self->heap, 0);
+
+  g_hash_table_iter_init (&iter, self->rules);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    rule_fire_queue_push (self, value, now);
+}
+
+static void
+rule_fire_queue_maybe_compact (RuleFireQueue *self)
+{
+  if (self->heap->len > 2 * g_hash_table_size (self->rules) + COMPACT_THRESHOLD)
+    rule_fire_queue_compact (self);
+}
+
+// Adds or updates <rule>; inactive rules are removed from the queue
+void
+rule_fire_queue_add (RuleFireQueue *self,
+                     const Rule    *rule)
+{
+  g_autoptr (GDateTime) now = NULL;
+  QueuedRule *queued = NULL;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (rule != NULL);
+
+  if (!rule->active)
+    {
+      rule_fire_queue_remove (self, rule->id);
+      return;
+    }
+
+  queued = g_hash_table_lookup (self->rules, GUINT_TO_POINTER (rule->id));
+  if (queued == NULL)
+    {
+      queued = g_new (QueuedRule, 1);
+      g_hash_table_insert (self->rules, GUINT_TO_POINTER (rule->id), queued);
+    }
+
+  queued->rule = *rule;
+  queued->generation = ++self->next_generation;
+
+  now = g_date_time_new_now_local ();
+  rule_fire_queue_push (self, queued, now);
+
+  rule_fire_queue_maybe_compact (self);
+}
+
+void
+rule_fire_queue_remove (RuleFireQueue *self,
+                        guint32        rule_id)
+{
+  g_return_if_fail (self != NULL);
+
+  // Its heap entries are discarded when they reach the top
+  if (g_hash_table_remove (self->rules, GUINT_TO_POINTER (rule_id)))
+    rule_fire_queue_maybe_compact (self);
+}
+
+void
+rule_fire_queue_clear (RuleFireQueue *self)
+{
+  g_return_if_fail (self != NULL);
+
+  g_array_set_size (self->heap, 0);
+  g_hash_table_remove_all (self->rules);
+}
+
+/*
+ * Gets the rule that fires next after <now>, and when. Returns FALSE if no
+ * active rule is queued. <rule> and <fire_time> may be NULL; <fire_time> is
+ * owned by the caller.
+ */
+gboolean
+rule_fire_queue_peek (RuleFireQueue  *self,
+                      GDateTime      *now,
+                      Rule           *rule,
+                      GDateTime     **fire_time)
+{
+  gint64 now_unix;
+
+  g_return_val_if_fail (self != NULL, FALSE);
+  g_return_val_if_fail (now != NULL, FALSE);
+
+  now_unix = g_date_time_to_unix (now);
+
+  while (self->heap->len > 0)
+    {
+      HeapEntry top = g_array_index (self->heap, HeapEntry, 0);
+      QueuedRule *queued = g_hash_table_lookup (self->rules, GUINT_TO_POINTER (top.rule_id));
+
+      // Outdated: the rule was removed, or added again
+      if (queued == NULL || queued->generation != top.generation)
+        {
+          rule_fire_queue_pop (self);
+          continue;
+        }
+
+      // Passed: re-key it to its next occurrence
+      if (top.fire_time <= now_unix)
+        {
+          rule_fire_queue_pop (self);
+          rule_fire_queue_push (self, queued, now);
+          continue;
+        }
+
+      if (rule != NULL)
+        *rule = queued->rule;
+
+      if (fire_time != NULL)
+        *fire_time = g_date_time_new_from_unix_local (top.fire_time);
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+RuleFireQueue *
+rule_fire_queue_ref (RuleFireQueue *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  g_atomic_ref_count_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+rule_fire_queue_unref (RuleFireQueue *self)
+{
+  g_return_if_fail (self != NULL);
+
+  if (!g_atomic_ref_count_dec (&self->ref_count))
+    return;
+
+  g_array_unref (self->heap);
+  g_hash_table_unref (self->rules);
+  g_free (self);
+}
+
+RuleFireQueue *
+rule_fire_queue_new (void)
+{
+  RuleFireQueue *self = g_new0 (RuleFireQueue, 1);
+
+  g_atomic_ref_count_init (&self->ref_count);
+  self->heap = g_array_new (FALSE, FALSE, sizeof (HeapEntry));
+  self->rules = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  self->next_generation = 0;
+
+  return self;
+}
@@ -0,0 +1,48 @@
+/* rule-fire-queue.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#define ALLOW_MANAGING_RULES
+#include "database-connection/database-connection.h"
+#undef ALLOW_MANAGING_RULES
+
+G_BEGIN_DECLS
+
+typedef struct _RuleFireQueue RuleFireQueue;
+
+RuleFireQueue *rule_fire_queue_new (void);
+RuleFireQueue *rule_fire_queue_ref (RuleFireQueue *self);
+void rule_fire_queue_unref (RuleFireQueue *self);
+
+void rule_fire_queue_add (RuleFireQueue *self, const Rule *rule);
+void rule_fire_queue_remove (RuleFireQueue *self, guint32 rule_id);
+void rule_fire_queue_clear (RuleFireQueue *self);
+
+gboolean rule_fire_queue_peek (RuleFireQueue  *self,
+                               GDateTime      *now,
+                               Rule           *rule,
+                               GDateTime     **fire_time);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (RuleFireQueue, rule_fire_queue_unref)
+
+G_END_DECLS
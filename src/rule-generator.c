@@ -0,0 +1,57 @@
+/* rule-generator.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * Synthetic rules, to measure how the application scales with the size of a
+ * table: written as CSV by "gawake --cli generate", so a throwaway database
+ * can be seeded with "gawake --cli import", and used in memory by
+ * gawake-benchmark. With the same seed, the same rules are generated.
+ */
+
+#include <string.h>
+
+#include "rule-generator.h"
+
+// Fills <rule> as the <number>th synthetic rule of <table>; <number> is its id
+void
+rule_generator_fill (GRand   *rand,
+                     guint32  number,
+                     Table    table,
+                     Rule    *rule)
+{
+  guint32 days = (guint32) g_rand_int_range (rand, 1, 1 << 7); // at least one day
+
+  memset (rule, 0, sizeof (Rule));
+
+  rule->id = number;
+  g_snprintf (rule->name, RULE_NAME_LENGTH, "Rule %u", number);
+  rule->hour = (uint8_t) g_rand_int_range (rand, 0, 24);
+  rule->minutes = (uint8_t) g_rand_int_range (rand, 0, 60);
+
+  for (gint day = 0; day < 7; day++)
+    rule->days[day] = (days & (1 << day)) != 0;
+
+  // Most rules are active
+  rule->active = g_rand_int_range (rand, 0, 10) != 0;
+
+  // Only turn off rules have a mode
+  rule->mode = (table == TABLE_OFF) ? (Mode) g_rand_int_range (rand, 0, MODE_LAST) : MODE_OFF;
+  rule->table = table;
+}
@@ -0,0 +1,112 @@
+/* rule-item.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * RuleItem is the model object of a rule list: it keeps a copy of the Rule
+ * record, so the (recycled) RuleRow widgets can be bound to it without
+ * querying the database again
+ */
+
+#include "rule-item.h"
+
+struct _RuleItem
+{
+  GObject             parent_instance;
+
+  /* Instance variables */
+  Rule                rule;
+};
+
+G_DEFINE_FINAL_TYPE (RuleItem, rule_item, G_TYPE_OBJECT)
+
+const Rule *
+rule_item_get_rule (RuleItem *self)
+{
+  g_return_val_if_fail (RULE_IS_ITEM (self), NULL);
+
+  return &self->rule;
+}
+
+void
+rule_item_set_rule (RuleItem   *self,
+                    const Rule *rule)
+{
+  g_return_if_fail (RULE_IS_ITEM (self));
+
+  self->rule = *rule;
+}
+
+void
+rule_item_set_active (RuleItem *self,
+                      gboolean  active)
+{
+  g_return_if_fail (RULE_IS_ITEM (self));
+
+  self->rule.active = (bool) active;
+}
+
+// Whether the item holds the same values as <rule>
+gboolean
+rule_item_equal (RuleItem   *self,
+                 const Rule *rule)
+{
+  const Rule *current = NULL;
+
+  g_return_val_if_fail (RULE_IS_ITEM (self), FALSE);
+
+  current = &self->rule;
+
+  if (current->id != rule->id
+      || current->hour != rule->hour
+      || current->minutes != rule->minutes
+      || current->active != rule->active
+      || current->mode != rule->mode
+      || current->table != rule->table
+      || g_strcmp0 (current->name, rule->name) != 0)
+    return FALSE;
+
+  for (gint i = 0; i < 7; i++)
+    if (current->days[i] != rule->days[i])
+      return FALSE;
+
+  return TRUE;
+}
+
+static void
+rule_item_class_init (RuleItemClass *klass)
+{
+  // Empty
+}
+
+static void
+rule_item_init (RuleItem *self)
+{
+  // Empty
+}
+
+RuleItem *
+rule_item_new (const Rule *rule)
+{
+  RuleItem *self = RULE_ITEM (g_object_new (RULE_TYPE_ITEM, NULL));
+
+  rule_item_set_rule (self, rule);
+
+  return self;
+}
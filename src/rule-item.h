@@ -0,0 +1,41 @@
+/* rule-item.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#define ALLOW_MANAGING_RULES
+#include "database-connection/database-connection.h"
+#undef ALLOW_MANAGING_RULES
+
+G_BEGIN_DECLS
+
+#define RULE_TYPE_ITEM (rule_item_get_type ())
+
+G_DECLARE_FINAL_TYPE (RuleItem, rule_item, RULE, ITEM, GObject)
+
+RuleItem *rule_item_new (const Rule *rule);
+const Rule *rule_item_get_rule (RuleItem *self);
+void rule_item_set_rule (RuleItem *self, const Rule *rule);
+void rule_item_set_active (RuleItem *self, gboolean active);
+gboolean rule_item_equal (RuleItem *self, const Rule *rule);
+
+G_END_DECLS
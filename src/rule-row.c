@@ -23,11 +23,13 @@
 #include <glib/gi18n.h>
 #include <inttypes.h>
 
-#include "database-connection/database-connection.h"
+#include "database-async.h"
+#include "rule-days.h"
+#include "gawake-clock-format.h"
 
 struct _RuleRow
 {
-  GtkListBoxRow              parent_instance;
+  AdwBin                     parent_instance;
 
   /* Template widgets */
   GtkLabel                  *title;
@@ -39,52 +41,14 @@ struct _RuleRow
   GtkButton                 *delete_button;
 
   /* Instance variables */
-  gint                       rule_id;
-  Table                      table;
+  RuleItem                  *item;
 };
 
-// Translations
-static const
-gchar *days_plural[] =
-{
-  N_("Sundays"),
-  N_("Mondays"),
-  N_("Tuesdays"),
-  N_("Wednesdays"),
-  N_("Thursdays"),
-  N_("Fridays"),
-  N_("Saturdays")
-};
-
-static const
-gchar *terms_plural[] =
-{
-  N_("Weekdays"),
-  N_("Weekends")
-};
-
-typedef enum
-{
-  TERMS_PLURAL_WEEKDAYS,
-  TERMS_PLURAL_WEEKENDS,
-  TERMS_PLURAL_LAST
-} TermsPlural;
-
-// Properties
-enum
-{
-  PROP_ID = 1,
-  PROP_TABLE,
-
-  N_PROPS
-};
-
-static GParamSpec *obj_properties[N_PROPS];
-
 // Signals
 enum
 {
   SIGNAL_RULE_DELETED,
+  SIGNAL_RULE_TOGGLED,
   SIGNAL_ERROR,
 
   N_SIGNALS
@@ -92,43 +56,47 @@ enum
 
 static guint obj_signals[N_SIGNALS];
 
-G_DEFINE_FINAL_TYPE (RuleRow, rule_row, GTK_TYPE_LIST_BOX_ROW)
+G_DEFINE_FINAL_TYPE (RuleRow, rule_row, ADW_TYPE_BIN)
 
-guint16
-rule_row_get_id (RuleRow *self)
+RuleItem *
+rule_row_get_item (RuleRow *self)
 {
-  return self->rule_id;
+  return self->item;
 }
 
 static void
-rule_row_emit_deleted (RuleRow *self)
+rule_row_emit_deleted (RuleRow  *self,
+                       RuleItem *item)
 {
   g_signal_emit (self,
                  obj_signals[SIGNAL_RULE_DELETED],
                  0,
-                 (guint) self->table);
+                 item);
 }
 
 static void
-rule_row_emit_error (RuleRow     *self,
-                     const gchar *error)
+rule_row_emit_toggled (RuleRow  *self,
+                       RuleItem *item)
 {
   g_signal_emit (self,
-                 obj_signals[SIGNAL_ERROR],
+                 obj_signals[SIGNAL_RULE_TOGGLED],
                  0,
-                 error);
+                 item);
 }
 
 static void
-rule_row_set_id (RuleRow *self,
-                 guint16  id)
+rule_row_emit_error (RuleRow     *self,
+                     const gchar *error)
 {
-  self->rule_id = id;
+  g_signal_emit (self,
+                 obj_signals[SIGNAL_ERROR],
+                 0,
+                 error);
 }
 
 static void
-rule_row_set_title (RuleRow  *self,
-                    gchar    *title)
+rule_row_set_title (RuleRow     *self,
+                    const gchar *title)
 {
   gtk_label_set_text (self->title, title);
 }
@@ -138,28 +106,31 @@ rule_row_set_time (RuleRow  *self,
                    guint8    _hour,
                    guint8    _minutes)
 {
-  TimeFormat format = time_converter_get_format ();
-  g_autofree gchar *time_formatted = NULL;
-  g_autoptr (GDateTime) rule_time = NULL;
-  g_autoptr (GDateTime) now = NULL;
-
-  /* Getting <now> time merely to use 'day', 'month' and 'year'
-   * to make a valid GDateTime for <rule_time>
-   */
-  now = g_date_time_new_now_local ();
-  rule_time = g_date_time_new_local (g_date_time_get_year (now),
-                                     g_date_time_get_month (now),
-                                     g_date_time_get_day_of_month (now),
-                                     _hour,
-                                     _minutes,
-                                     00);
-
-  time_formatted = g_date_time_format (rule_time,
-                                       (format == TIME_FORMAT_TWELVE) ? "%I:%M %p" : "%H:%M");
+  gchar time_formatted[GAWAKE_CLOCK_FORMAT_TIME_LENGTH];
 
+  // Formatted without allocating; no-op if the label already shows it
+  gawake_clock_format_format_time (gawake_clock_format_get_default (),
+                                   _hour, _minutes,
+                                   time_formatted);
   gtk_label_set_text (self->time, time_formatted);
 }
 
+// Only the rows alive (bound by the list view) follow a clock format switch
+static void
+rule_row_clock_format_changed (GObject    *object,
+                               GParamSpec *pspec,
+                               gpointer    user_data)
+{
+  RuleRow *self = RULE_ROW (user_data);
+  const Rule *rule = NULL;
+
+  if (self->item == NULL)
+    return;
+
+  rule = rule_item_get_rule (self->item);
+  rule_row_set_time (self, rule->hour, rule->minutes);
+}
+
 static void
 rule_row_set_mode (RuleRow  *self,
                    Mode      mode)
@@ -173,216 +144,158 @@ rule_row_set_mode (RuleRow  *self,
   gtk_label_set_text (self->mode, formatted_mode);
 }
 
+// Labels are built once per combination of days, see rule-days.c
 static void
-rule_row_set_table (RuleRow  *self,
-                    Table     table)
+rule_row_set_repeats (RuleRow    *self,
+                      const bool  days[7])
 {
-  self->table = table;
+  gtk_label_set_text (self->repeats, rule_days_get_label (rule_days_from_array (days)));
 }
 
-// Bruh, it's 01/01/2025, 00:24 and I'm writing this code
 static void
-rule_row_set_repeats (RuleRow    *self,
-                      bool        days[7])
+rule_row_change_active_ready (GObject      *source_object,
+                              GAsyncResult *result,
+                              gpointer      user_data)
 {
-  gint sum = 0;
-  GString *repeated_days = g_string_new ("");
-  g_autoptr (GBytes) repeated_days_bytes = NULL;
-  g_autofree gchar *repeated_days_formatted = NULL;
+  g_autoptr (RuleItem) item = RULE_ITEM (user_data);
+  g_autoptr (GError) error = NULL;
+  RuleRow *row = RULE_ROW (source_object);
+  gboolean active = !rule_item_get_rule (item)->active;
 
-  for (gint i = 0; i < 7; i++)
-    sum += (days[i]) ? 1 : 0;
-
-  // Set a string for repetition
-  if (sum == 7)
+  if (!database_async_rule_enable_disable_finish (result, &error))
     {
-      // ...if all days are set;
-      gtk_label_set_text (self->repeats, _("Every Day"));
+      rule_row_emit_error (row, _("Failed to change rule state"));
+      active = rule_item_get_rule (item)->active;
     }
-
-  else if (sum == 5
-           && (!days[0] && !days[6]))
+  else
     {
-      // ...weekdays
-      gtk_label_set_text (self->repeats, gettext (terms_plural[TERMS_PLURAL_WEEKDAYS]));
+      rule_item_set_active (item, active);
+      rule_row_emit_toggled (row, item);
     }
 
-  else if (sum == 2
-           && (days[0] && days[6]))
+  // The row may have been recycled meanwhile
+  if (row->item == item)
     {
-      // ...weekends
-      gtk_label_set_text (self->repeats, gettext (terms_plural[TERMS_PLURAL_WEEKENDS]));
+      gtk_switch_set_active (row->active_toggle, active);
+      gtk_switch_set_state (row->active_toggle, active);
     }
+}
 
-  else if (sum == 1)
-    {
-      // ...if only one day is set
-      for (int i = 0; i < 7; i++)
-        {
-          if (days[i])
-            {
-              gtk_label_set_text (self->repeats, gettext (days_plural[i]));
-              break;
-            }
-        }
-    }
+static gboolean
+rule_row_change_active (GtkSwitch* self,
+                        gboolean state,
+                        gpointer user_data)
+{
+  RuleRow *row = RULE_ROW (user_data);
+  const Rule *rule = NULL;
 
-  else if (sum == 0)
-    {
-      // ...if any day is set;
-      // translators: the rule repeats any day of the week
-      gtk_label_set_text (self->repeats, _("Any Day"));
-    }
+  if (row->item == NULL)
+    return TRUE;
 
-  else
+  rule = rule_item_get_rule (row->item);
+
+  // Nothing to write (e.g. the state was restored after a failure)
+  if ((bool) state == rule->active)
     {
-      // ...if only some days are set
-      for (gint i = 0; i < 7; i++)
-        if (days[i])
-          g_string_append_printf (repeated_days,
-                                  "%s, ",
-                                  gettext (days_plural[i]));
-
-      // remove the last unnecessary ", "
-      repeated_days = g_string_truncate (repeated_days, repeated_days->len - 2);
-      repeated_days_formatted = g_string_free (repeated_days, FALSE);
-      gtk_label_set_text (self->repeats, repeated_days_formatted);
-      repeated_days = NULL;
+      gtk_switch_set_state (self, state);
+      return TRUE;
     }
 
-  if (repeated_days != NULL)
-    g_string_free (repeated_days, TRUE);
+  database_async_rule_enable_disable (row,
+                                      rule->id,
+                                      rule->table,
+                                      (bool) state,
+                                      NULL,
+                                      rule_row_change_active_ready,
+                                      g_object_ref (row->item));
+
+  return TRUE;
 }
 
 static void
 rule_row_set_active (RuleRow      *self,
                      gboolean      active)
 {
+  // The value comes from the database, so don't write it back
+  g_signal_handlers_block_by_func (self->active_toggle, rule_row_change_active, self);
   gtk_switch_set_active (self->active_toggle, active);
+  g_signal_handlers_unblock_by_func (self->active_toggle, rule_row_change_active, self);
 }
 
-static gboolean
-rule_row_change_active (GtkSwitch* self,
-                        gboolean state,
-                        gpointer user_data)
+static void
+rule_row_delete_rule_ready (GObject      *source_object,
+                            GAsyncResult *result,
+                            gpointer      user_data)
 {
-  gint status = 0;
-  RuleRow *row = RULE_ROW (user_data);
-
-  status = rule_enable_disable (row->rule_id, row->table, (bool) state);
+  g_autoptr (RuleItem) item = RULE_ITEM (user_data);
+  g_autoptr (GError) error = NULL;
+  RuleRow *row = RULE_ROW (source_object);
 
-  if (status == EXIT_FAILURE)
-    rule_row_emit_error (row, _("Failed to change rule state"));
+  if (!database_async_rule_delete_finish (result, &error))
+    rule_row_emit_error (row, _("Failed to dele rule"));
   else
-    gtk_switch_set_state (self, state);
-
-  return TRUE;
+    rule_row_emit_deleted (row, item);
 }
 
 static void
 rule_row_delete_rule (GtkButton *self,
                       gpointer   user_data)
 {
-  gint status = 0;
   RuleRow *row = RULE_ROW (user_data);
+  const Rule *rule = NULL;
 
-  status = rule_delete (row->rule_id, row->table);
+  if (row->item == NULL)
+    return;
 
-  if (status == EXIT_FAILURE)
-    rule_row_emit_error (row, _("Failed to dele rule"));
-  else
-    gtk_widget_set_visible (GTK_WIDGET (row), FALSE);
+  rule = rule_item_get_rule (row->item);
 
-  rule_row_emit_deleted (row);
+  database_async_rule_delete (row,
+                              rule->id,
+                              rule->table,
+                              NULL,
+                              rule_row_delete_rule_ready,
+                              g_object_ref (row->item));
 }
 
-void
-rule_row_update_fields (RuleRow *self)
+static void
+rule_row_set_fields (RuleRow    *self,
+                     const Rule *rule)
 {
-  Rule rule;
-
-  if (rule_get_single (self->rule_id, self->table, &rule) == EXIT_FAILURE)
-    {
-      rule_row_emit_error (self, _("Failed to update rule"));
-      return;
-    }
-
-  rule_row_set_id (self, rule.id);
-  rule_row_set_title (self, rule.name);
-  rule_row_set_time (self, rule.hour, rule.minutes);
+  rule_row_set_title (self, rule->name);
+  rule_row_set_time (self, rule->hour, rule->minutes);
 
-  if (rule.table == TABLE_OFF)
-    rule_row_set_mode (self, rule.mode);
+  if (rule->table == TABLE_OFF)
+    rule_row_set_mode (self, rule->mode);
+  else
+    gtk_revealer_set_reveal_child (self->mode_revealer, FALSE);
 
-  rule_row_set_table (self, rule.table);
-  rule_row_set_repeats (self, rule.days);
-  rule_row_set_active (self, (gboolean) rule.active);
+  rule_row_set_repeats (self, rule->days);
+  rule_row_set_active (self, (gboolean) rule->active);
 }
 
-static void
-rule_row_constructed (GObject *gobject)
+/*
+ * Rows are recycled by the list view, so a row shows whatever item it is
+ * currently bound to; the fields come from the item, no query is made
+ */
+void
+rule_row_bind (RuleRow  *self,
+               RuleItem *item)
 {
-  RuleRow *self = RULE_ROW (gobject);
-  Rule rule =
-    {
-      .id = 0,
-      .name = "",
-      .hour = 00,
-      .minutes = 00,
-      .days = {0, 0, 0, 0, 0, 0, 0},
-      .mode = MODE_LAST,
-      .table = TABLE_LAST
-    };
-  gint status;
-  G_OBJECT_CLASS (rule_row_parent_class)->constructed (gobject);
-
-  status = rule_get_single (self->rule_id, self->table, &rule);
-
-  if (status == EXIT_SUCCESS)
-    {
-      rule_row_set_id (self, rule.id);
-      rule_row_set_title (self, rule.name);
-      rule_row_set_time (self, rule.hour, rule.minutes);
-
-      if (rule.table == TABLE_OFF)
-        rule_row_set_mode (self, rule.mode);
-
-      rule_row_set_table (self, rule.table);
-      rule_row_set_repeats (self, rule.days);
-      rule_row_set_active (self, (gboolean) rule.active);
-    }
-  else
-    {
-      g_warning ("Failed to get rule at construct step");
-    }
+  g_set_object (&self->item, item);
+  rule_row_set_fields (self, rule_item_get_rule (item));
 }
 
-static void
-rule_row_set_property (GObject      *object,
-                       guint         property_id,
-                       const GValue *value,
-                       GParamSpec   *pspec)
+void
+rule_row_unbind (RuleRow *self)
 {
-  RuleRow *self = RULE_ROW (object);
-
-  switch (property_id)
-    {
-    case PROP_ID:
-      self->rule_id = (uint16_t) g_value_get_int (value);
-      break;
-
-    case PROP_TABLE:
-      self->table = (Table) g_value_get_int (value);
-      break;
-
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
-    }
+  g_clear_object (&self->item);
 }
 
 static void
 rule_row_dispose (GObject *gobject)
 {
+  g_clear_object (&RULE_ROW (gobject)->item);
+
   gtk_widget_dispose_template (GTK_WIDGET (gobject), RULE_TYPE_ROW);
 
   G_OBJECT_CLASS (rule_row_parent_class)->dispose (gobject);
@@ -405,34 +318,6 @@ rule_row_class_init (RuleRowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, RuleRow, active_toggle);
   gtk_widget_class_bind_template_child (widget_class, RuleRow, delete_button);
 
-  // Properties
-  obj_properties[PROP_ID] =
-    g_param_spec_int ("id",
-                      NULL, NULL,
-                      0, UINT16_MAX,
-                      0,
-                      G_PARAM_CONSTRUCT_ONLY |
-                      G_PARAM_WRITABLE |
-                      G_PARAM_STATIC_NAME);
-
-  obj_properties[PROP_TABLE] =
-    g_param_spec_int ("table",
-                      NULL, NULL,
-                      0, (TABLE_LAST-1),
-                      TABLE_ON,
-                      G_PARAM_CONSTRUCT_ONLY |
-                      G_PARAM_WRITABLE |
-                      G_PARAM_STATIC_NAME);
-
-  G_OBJECT_CLASS (klass)->set_property = rule_row_set_property;
-
-  g_object_class_install_properties (G_OBJECT_CLASS (klass),
-                                     N_PROPS,
-                                     obj_properties);
-
-  // Constructor
-  G_OBJECT_CLASS (klass)->constructed = rule_row_constructed;
-
   G_OBJECT_CLASS (klass)->dispose = rule_row_dispose;
 
   // Signals
@@ -445,7 +330,18 @@ rule_row_class_init (RuleRowClass *klass)
                   NULL,
                   G_TYPE_NONE,            // no return value
                   1,                      // 1 argument
-                  G_TYPE_UINT);           // table
+                  RULE_TYPE_ITEM);        // deleted item
+
+  obj_signals[SIGNAL_RULE_TOGGLED] =
+    g_signal_new ("rule-toggled",
+                  RULE_TYPE_ROW,
+                  G_SIGNAL_RUN_FIRST,
+                  0,
+                  NULL, NULL,
+                  NULL,
+                  G_TYPE_NONE,            // no return value
+                  1,                      // 1 argument
+                  RULE_TYPE_ITEM);        // enabled or disabled item
 
   obj_signals[SIGNAL_ERROR] =
     g_signal_new ("error",
@@ -462,6 +358,8 @@ rule_row_class_init (RuleRowClass *klass)
 static void
 rule_row_init (RuleRow *self)
 {
+  self->item = NULL;
+
   gtk_widget_init_template (GTK_WIDGET (self));
 
   gtk_label_set_text (self->title, _("Unnamed rule"));
@@ -477,14 +375,16 @@ rule_row_init (RuleRow *self)
                     "clicked",
                     G_CALLBACK (rule_row_delete_rule),
                     self);
+
+  g_signal_connect_object (gawake_clock_format_get_default (),
+                           "notify::twelve-hour",
+                           G_CALLBACK (rule_row_clock_format_changed),
+                           self,
+                           0);
 }
 
 RuleRow *
-rule_row_new (Table    table,
-              uint16_t rule_id)
+rule_row_new (void)
 {
-  return RULE_ROW (g_object_new (RULE_TYPE_ROW,
-                                 "table", table,
-                                 "id", rule_id,
-                                 NULL));
+  return RULE_ROW (g_object_new (RULE_TYPE_ROW, NULL));
 }
@@ -20,21 +20,20 @@
 
 #pragma once
 
-#include <gtk/gtk.h>
+#include <adwaita.h>
 
-#define ALLOW_MANAGING_RULES
-#include "database-connection/database-connection.h"
-#undef ALLOW_MANAGING_RULES
+#include "rule-item.h"
 
 G_BEGIN_DECLS
 
 #define RULE_TYPE_ROW (rule_row_get_type ())
 
-G_DECLARE_FINAL_TYPE (RuleRow, rule_row, RULE, ROW, GtkListBoxRow)
+G_DECLARE_FINAL_TYPE (RuleRow, rule_row, RULE, ROW, AdwBin)
 
-RuleRow *rule_row_new (Table table, uint16_t rule_id);
-guint16 rule_row_get_id (RuleRow *self);
-void rule_row_update_fields (RuleRow *self);
+RuleRow *rule_row_new (void);
+RuleItem *rule_row_get_item (RuleRow *self);
+void rule_row_bind (RuleRow *self, RuleItem *item);
+void rule_row_unbind (RuleRow *self);
 
 G_END_DECLS
 
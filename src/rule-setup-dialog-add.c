@@ -29,7 +29,7 @@ struct _RuleSetupDialogAdd
 
 G_DEFINE_FINAL_TYPE (RuleSetupDialogAdd, rule_setup_dialog_add, RULE_TYPE_SETUP_DIALOG)
 
-static guint16
+static guint32
 rule_setup_dialog_add_perform_action (Rule *rule)
 {
   return rule_add (rule);
@@ -29,7 +29,7 @@ struct _RuleSetupDialogEdit
 
 G_DEFINE_FINAL_TYPE (RuleSetupDialogEdit, rule_setup_dialog_edit, RULE_TYPE_SETUP_DIALOG)
 
-static guint16
+static guint32
 rule_setup_dialog_edit_perform_action (Rule *rule)
 {
   return rule_edit (rule);
@@ -50,12 +50,10 @@ rule_setup_dialog_edit_init (RuleSetupDialogEdit *self)
 }
 
 RuleSetupDialogEdit *
-rule_setup_dialog_edit_new (Table   table,
-                            guint16 rule_id)
+rule_setup_dialog_edit_new (Table table)
 {
   return RULE_SETUP_DIALOG_EDIT (g_object_new (RULE_TYPE_SETUP_DIALOG_EDIT,
                                                "table", table,
-                                               "id", rule_id,
                                                "title", (table == TABLE_ON) ?
                                                         _("Edit turn on rule") : _("Edit turn off rule"),
                                                // translators: Rule Setup Dialog action button, for editing a rule
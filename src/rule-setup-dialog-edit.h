@@ -28,6 +28,6 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (RuleSetupDialogEdit, rule_setup_dialog_edit, RULE, SETUP_DIALOG_EDIT, RuleSetupDialog)
 
-RuleSetupDialogEdit *rule_setup_dialog_edit_new (Table table, guint16 rule_id);
+RuleSetupDialogEdit *rule_setup_dialog_edit_new (Table table);
 
 G_END_DECLS
@@ -22,9 +22,16 @@
 
 #include "rule-setup-dialog.h"
 #include "rule-setup-dialog-edit.h"
+#include "database-async.h"
+#include "rule-time-index.h"
 #include "days-row.h"
 #include "mode-row.h"
 #include "time-chooser.h"
+#include "gawake-clock-format.h"
+#include "rule-days.h"
+
+// Minutes, if the "conflict-window" setting isn't available
+#define DEFAULT_CONFLICT_WINDOW 5
 
 typedef struct
 {
@@ -34,25 +41,26 @@ typedef struct
   AdwEntryRow           *name_entry;
   ModeRow               *mode_row;
   AdwBin                *days_row_bin;
-  AdwBin                *conflicting_days_row_bin;
-  GtkLabel              *conflicting_rule_title;
-  GtkLabel              *conflicting_rule_time;
+  GtkLabel              *warn_label;
+  GtkListBox            *conflicting_rules_list;
   GtkRevealer           *conflicting_rule_revealer;
   TimeChooser           *time_chooser;
 
   /* Instance variables */
-  guint16               rule_id;
+  guint32               rule_id;
   Table                 table;
   gboolean              active;
   Mode                  mode;
-  RuleTimeValidator    *rule_time_validator;
+  RuleTimeIndex        *time_index;
+  GCancellable         *cancellable;
+  GCancellable         *conflict_cancellable;
+  guint                 conflict_window;
 } RuleSetupDialogPrivate;
 
 // Properties
 enum
 {
-  PROP_ID = 1,
-  PROP_TABLE,
+  PROP_TABLE = 1,
   PROP_ACTIVE,
   PROP_TITLE,
   PROP_ACTION_BUTTON_LABEL,
@@ -81,11 +89,25 @@ rule_setup_dialog_finish (RuleSetupDialog *self)
   gtk_window_close (GTK_WINDOW (self));
 }
 
+/*
+ * Index of the rules of the dialog table, used to check for conflicting times;
+ * it's owned (and kept up to date) by the caller, the dialog only keeps a reference
+ */
+void
+rule_setup_dialog_set_time_index (RuleSetupDialog *self,
+                                  RuleTimeIndex   *time_index)
+{
+  RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
+
+  g_clear_pointer (&priv->time_index, rule_time_index_unref);
+  priv->time_index = rule_time_index_ref (time_index);
+}
+
 static void
 rule_setup_dialog_emit_done (RuleSetupDialog *self,
                              gboolean         cancelled,
                              Table            table,
-                             guint16          rule_id)
+                             guint32          rule_id)
 {
   g_signal_emit (self,
                  obj_signals[SIGNAL_DONE],
@@ -125,8 +147,8 @@ rule_setup_dialog_read_values (RuleSetupDialog *self,
   rule->minutes = (uint8_t) time_chooser_get_minutes (priv->time_chooser);
 
   // Days
-  days_row_get_activated (DAYS_ROW (adw_bin_get_child (priv->days_row_bin)),
-                          rule->days);
+  rule_days_to_array (days_row_get_days (DAYS_ROW (adw_bin_get_child (priv->days_row_bin))),
+                      rule->days);
 
   // Active
   rule->active = priv->active;
@@ -138,58 +160,145 @@ rule_setup_dialog_read_values (RuleSetupDialog *self,
   rule->table = priv->table;
 }
 
-static void
-rule_setup_dialog_set_conflicting_rule (RuleSetupDialog *self,
-                                        guint16          conflicting_rule_id)
+static GtkWidget *
+rule_setup_dialog_conflicting_rule_row_new (RuleSetupDialog *self,
+                                            const Rule      *rule)
 {
-  Rule rule;
   RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
-  const gulong time_length = 6; // HH:MM AM'\n' == 9
-  gchar rule_time[time_length];
+  AdwActionRow *row = ADW_ACTION_ROW (adw_action_row_new ());
+  gchar rule_time[GAWAKE_CLOCK_FORMAT_TIME_LENGTH];
+  g_autofree gchar *subtitle = NULL;
 
-  if (rule_get_single (conflicting_rule_id, priv->table, &rule) == EXIT_FAILURE)
-    return;
+  // On the system clock format, like on the rule rows
+  gawake_clock_format_format_time (gawake_clock_format_get_default (),
+                                   rule->hour, rule->minutes,
+                                   rule_time);
 
-  g_snprintf (rule_time, time_length,
-              "%02d:%02d", rule.hour, rule.minutes);
+  if (rule->table == priv->table)
+    subtitle = g_strdup_printf ("%s · %s", rule_time, rule_days_get_label (rule_days_from_array (rule->days)));
+  else
+    subtitle = g_strdup_printf ("%s · %s · %s", rule_time, rule_days_get_label (rule_days_from_array (rule->days)),
+                                (rule->table == TABLE_ON) ? _("Turn on rule") : _("Turn off rule"));
 
-  gtk_label_set_label (priv->conflicting_rule_title, rule.name);
-  gtk_label_set_label (priv->conflicting_rule_time, rule_time);
-  days_row_set_activated (DAYS_ROW (adw_bin_get_child (priv->conflicting_days_row_bin)),
-                          rule.days);
-  gtk_revealer_set_reveal_child (priv->conflicting_rule_revealer, TRUE);
+  adw_preferences_row_set_use_markup (ADW_PREFERENCES_ROW (row), FALSE);
+  adw_preferences_row_set_title (ADW_PREFERENCES_ROW (row), rule->name);
+  adw_action_row_set_subtitle (row, subtitle);
+
+  return GTK_WIDGET (row);
 }
 
-static gboolean
-rule_setup_dialog_check_for_conflicting_rule (RuleSetupDialog *self)
+// Lists <conflicts> (NULL or empty hides the warning)
+static void
+rule_setup_dialog_show_conflicting_rules (RuleSetupDialog *self,
+                                          GArray          *conflicts)
 {
-  Rule incoming_rule;
   RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
-  guint16 rule_id = 0;
-  guint16 conflicting_rule_id = 0;
+  GtkWidget *child = NULL;
+  gboolean same_table = FALSE;
 
-  rule_setup_dialog_read_values (self, &incoming_rule);
-
-  // When the rule is being edited, only check for conflicting time if days or time was changed
-  if (RULE_IS_SETUP_DIALOG_EDIT (self))
-    rule_id = priv->rule_id;
-
-  conflicting_rule_id = rule_validate_time (priv->rule_time_validator,
-                                            rule_id,
-                                            incoming_rule.hour,
-                                            incoming_rule.minutes,
-                                            incoming_rule.days);
-
-  if (conflicting_rule_id == 0)
+  if (conflicts == NULL || conflicts->len == 0)
     {
       gtk_revealer_set_reveal_child (priv->conflicting_rule_revealer, FALSE);
-      return FALSE;
+      return;
     }
-  else
+
+  while ((child = gtk_widget_get_first_child (GTK_WIDGET (priv->conflicting_rules_list))) != NULL)
+    gtk_list_box_remove (priv->conflicting_rules_list, child);
+
+  for (guint i = 0; i < conflicts->len; i++)
     {
-      rule_setup_dialog_set_conflicting_rule (self, conflicting_rule_id);
-      return TRUE;
+      const Rule *rule = &g_array_index (conflicts, Rule, i);
+
+      same_table |= (rule->table == priv->table);
+      gtk_list_box_append (priv->conflicting_rules_list,
+                           rule_setup_dialog_conflicting_rule_row_new (self, rule));
     }
+
+  if (same_table)
+    gtk_label_set_label (priv->warn_label, _("You already have a rule at this time:"));
+  else if (priv->table == TABLE_ON)
+    gtk_label_set_label (priv->warn_label, _("There are turn off rules close to this time:"));
+  else
+    gtk_label_set_label (priv->warn_label, _("There are turn on rules close to this time:"));
+
+  gtk_revealer_set_reveal_child (priv->conflicting_rule_revealer, TRUE);
+}
+
+// From the "conflict-window" setting, if its schema is installed
+static guint
+rule_setup_dialog_get_conflict_window (void)
+{
+  GSettingsSchemaSource *source = g_settings_schema_source_get_default ();
+  g_autoptr (GSettingsSchema) schema = NULL;
+  g_autoptr (GSettings) settings = NULL;
+
+  if (source != NULL)
+    schema = g_settings_schema_source_lookup (source, "io.github.gawake.Gawake", TRUE);
+
+  if (schema == NULL || !g_settings_schema_has_key (schema, "conflict-window"))
+    return DEFAULT_CONFLICT_WINDOW;
+
+  settings = g_settings_new_full (schema, NULL, NULL);
+
+  return g_settings_get_uint (settings, "conflict-window");
+}
+
+// When the rule is being edited, it doesn't conflict with itself
+static guint32
+rule_setup_dialog_get_excluded_id (RuleSetupDialog *self)
+{
+  RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
+
+  return RULE_IS_SETUP_DIALOG_EDIT (self) ? priv->rule_id : 0;
+}
+
+static void
+rule_setup_dialog_check_for_conflicting_rule_ready (GObject      *source_object,
+                                                    GAsyncResult *result,
+                                                    gpointer      user_data)
+{
+  g_autoptr (GArray) conflicts = NULL;
+  g_autoptr (GError) error = NULL;
+
+  conflicts = rule_time_index_lookup_finish (result, &error);
+
+  // Superseded by a newer check, or the dialog is gone
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  rule_setup_dialog_show_conflicting_rules (RULE_SETUP_DIALOG (source_object), conflicts);
+}
+
+/*
+ * Checks the current values on a worker thread, so editing never waits on
+ * it; a newer check cancels the one in flight. The result carries the
+ * conflicting rules, so they are shown without querying the database: the
+ * ones of this table at the same time, and the ones of the other table
+ * within the conflict window (e.g. a shutdown right after a wake-up).
+ */
+static void
+rule_setup_dialog_check_for_conflicting_rule (RuleSetupDialog *self)
+{
+  RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
+
+  if (priv->time_index == NULL)
+    return;
+
+  g_cancellable_cancel (priv->conflict_cancellable);
+  g_clear_object (&priv->conflict_cancellable);
+  priv->conflict_cancellable = g_cancellable_new ();
+
+  rule_time_index_lookup_async (priv->time_index,
+                                rule_time_index_get_default ((priv->table == TABLE_ON) ? TABLE_OFF : TABLE_ON),
+                                self,
+                                rule_setup_dialog_get_excluded_id (self),
+                                time_chooser_get_hour24 (priv->time_chooser),
+                                time_chooser_get_minutes (priv->time_chooser),
+                                days_row_get_days (DAYS_ROW (adw_bin_get_child (priv->days_row_bin))),
+                                priv->conflict_window,
+                                priv->conflict_cancellable,
+                                rule_setup_dialog_check_for_conflicting_rule_ready,
+                                NULL);
 }
 
 /*
@@ -206,11 +315,99 @@ rule_setup_dialod_value_changed (gpointer __widget_instance__,
   rule_setup_dialog_check_for_conflicting_rule (RULE_SETUP_DIALOG (user_data));
 }
 
+/*
+ * Binds the dialog to @rule, for editing it, or clears the fields for a new
+ * rule if @rule is NULL. Dialogs are kept alive between uses (closing only
+ * hides them), so they are set up from the rule the caller already has
+ * instead of reading it again from the database.
+ */
+void
+rule_setup_dialog_set_rule (RuleSetupDialog *self,
+                            const Rule      *rule)
+{
+  RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
+  DaysRow *days_row = DAYS_ROW (adw_bin_get_child (priv->days_row_bin));
+  g_autoptr (GDateTime) now = NULL;
+  RuleDays days = RULE_DAYS_NONE;
+
+  // Drop whatever was still pending from the previous use
+  g_cancellable_cancel (priv->cancellable);
+  g_clear_object (&priv->cancellable);
+  priv->cancellable = g_cancellable_new ();
+  g_cancellable_cancel (priv->conflict_cancellable);
+
+  // Picks up changes to the setting made while the dialog was hidden
+  priv->conflict_window = rule_setup_dialog_get_conflict_window ();
+
+  if (rule != NULL)
+    {
+      priv->rule_id = rule->id;
+      priv->active = rule->active;
+
+      gtk_editable_set_text (GTK_EDITABLE (priv->name_entry), rule->name);
+      time_chooser_set_hour24 (priv->time_chooser, (gdouble) rule->hour);
+      time_chooser_set_minutes (priv->time_chooser, (gdouble) rule->minutes);
+      days = rule_days_from_array (rule->days);
+
+      if (priv->table == TABLE_OFF)
+        mode_row_set_mode (priv->mode_row, (guint) rule->mode);
+    }
+  else
+    {
+      // Added rules are active by default
+      priv->rule_id = 0;
+      priv->active = TRUE;
+
+      now = g_date_time_new_now_local ();
+      gtk_editable_set_text (GTK_EDITABLE (priv->name_entry), "");
+      time_chooser_set_hour24 (priv->time_chooser, (gdouble) g_date_time_get_hour (now));
+      time_chooser_set_minutes (priv->time_chooser, (gdouble) g_date_time_get_minute (now));
+      mode_row_set_mode (priv->mode_row, (guint) MODE_OFF);
+    }
+
+  days_row_set_days (days_row, days);
+
+  gtk_revealer_set_reveal_child (priv->conflicting_rule_revealer, FALSE);
+  gtk_widget_set_sensitive (GTK_WIDGET (priv->action_button), TRUE);
+  gtk_widget_grab_focus (GTK_WIDGET (priv->name_entry));
+}
+
+static void
+rule_setup_dialog_action_ready (GObject      *source_object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+  RuleSetupDialog *self = NULL;
+  RuleSetupDialogPrivate *priv = NULL;
+  guint32 rule_id;
+
+  rule_id = database_async_rule_action_finish (result, &error);
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = RULE_SETUP_DIALOG (source_object);
+  priv = rule_setup_dialog_get_instance_private (self);
+
+  gtk_widget_set_sensitive (GTK_WIDGET (priv->action_button), TRUE);
+
+  if (rule_id == 0)
+    adw_toast_overlay_add_toast (priv->toast,
+                                 adw_toast_new (_("Operation failed")));
+  else
+    rule_setup_dialog_emit_done (self,
+                                 FALSE,
+                                 priv->table,
+                                 rule_id);
+}
+
 static void
 rule_setup_dialog_action_button_clicked (GtkButton *button,
                                          gpointer   user_data)
 {
   Rule incoming_rule;
+  g_autoptr (GArray) conflicts = NULL;
   RuleSetupDialog *self = RULE_SETUP_DIALOG (user_data);
   RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
   RuleSetupDialogClass *klass = RULE_SETUP_DIALOG_GET_CLASS (self);
@@ -225,20 +422,37 @@ rule_setup_dialog_action_button_clicked (GtkButton *button,
       return;
     }
 
-  // Check if the incoming rule is conflicting with another
-  if (rule_setup_dialog_check_for_conflicting_rule (self))
-    return;
+  /* Check if the incoming rule is conflicting with another of this table;
+   * it must be settled before submitting, and the lookup is cheap enough
+   * to do it here. Rules of the other table close to it are only a warning.
+   */
+  g_cancellable_cancel (priv->conflict_cancellable);
+  if (priv->time_index != NULL)
+    {
+      conflicts = g_array_new (FALSE, FALSE, sizeof (Rule));
+      rule_time_index_collect (priv->time_index,
+                               rule_setup_dialog_get_excluded_id (self),
+                               incoming_rule.hour,
+                               incoming_rule.minutes,
+                               rule_days_from_array (incoming_rule.days),
+                               0,
+                               conflicts);
+
+      if (conflicts->len > 0)
+        {
+          rule_setup_dialog_show_conflicting_rules (self, conflicts);
+          return;
+        }
+    }
 
-  // Perform action if rule is valid
-  incoming_rule.id = klass->perform_action (&incoming_rule);
-  if (incoming_rule.id == 0)
-    adw_toast_overlay_add_toast (priv->toast,
-                                 adw_toast_new (_("Operation failed")));
-  else
-    rule_setup_dialog_emit_done (self,
-                                 FALSE,
-                                 priv->table,
-                                 incoming_rule.id);
+  // Perform action if rule is valid; avoid submitting it twice meanwhile
+  gtk_widget_set_sensitive (GTK_WIDGET (button), FALSE);
+  database_async_rule_action (self,
+                              klass->perform_action,
+                              &incoming_rule,
+                              priv->cancellable,
+                              rule_setup_dialog_action_ready,
+                              NULL);
 }
 
 static void
@@ -252,10 +466,6 @@ rule_setup_dialog_set_property (GObject      *object,
 
   switch (property_id)
     {
-    case PROP_ID:
-      priv->rule_id = (uint16_t) g_value_get_int (value);
-      break;
-
     case PROP_TABLE:
       priv->table = (Table) g_value_get_int (value);
       break;
@@ -277,7 +487,7 @@ rule_setup_dialog_set_property (GObject      *object,
     }
 }
 
-static guint16
+static guint32
 rule_setup_dialog_perform_action (Rule *rule)
 {
   g_warning ("Action not implemented");
@@ -289,58 +499,11 @@ rule_setup_dialog_constructed (GObject *gobject)
 {
   RuleSetupDialog *self = RULE_SETUP_DIALOG (gobject);
   RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
-  Rule rule =
-    {
-      .id = 0,
-      .name = "",
-      .hour = 00,
-      .minutes = 00,
-      .days = {0, 0, 0, 0, 0, 0, 0},
-      .mode = MODE_LAST,
-      .table = TABLE_LAST
-    };
 
   G_OBJECT_CLASS (rule_setup_dialog_parent_class)->constructed (gobject);
 
-  // Init time validator
-  priv->rule_time_validator = rule_validate_time_init (priv->table);
-  if (priv->rule_time_validator == NULL)
-    g_warning ("Failed to get RuleTimeValidator");
-
   // Reveal/hide mode
   gtk_widget_set_visible (GTK_WIDGET (priv->mode_row), (priv->table == TABLE_OFF));
-
-  // If the rule has an id != 0, set the dialog fields (for editing it)
-  if (priv->rule_id == 0)
-    return;
-
-  if (rule_get_single (priv->rule_id, priv->table, &rule) == EXIT_SUCCESS)
-    {
-      // Name
-      gtk_editable_set_text (GTK_EDITABLE (priv->name_entry), rule.name);
-
-      // Hour
-      time_chooser_set_hour24 (priv->time_chooser, (gdouble) rule.hour);
-
-      // Minutes
-      time_chooser_set_minutes (priv->time_chooser, (gdouble) rule.minutes);
-
-      // Active
-      priv->active = rule.active;
-
-      // Days
-      days_row_set_activated (DAYS_ROW (adw_bin_get_child (priv->days_row_bin)),
-                              rule.days);
-
-      // Mode
-      if (priv->table == TABLE_OFF)
-        mode_row_set_mode (priv->mode_row, (guint) rule.mode);
-    }
-  else
-    {
-      adw_toast_overlay_add_toast (priv->toast,
-                                   adw_toast_new (_("Failed to get rule attributes")));
-    }
 }
 
 static void
@@ -355,7 +518,12 @@ rule_setup_dialog_dispose (GObject* object)
   RuleSetupDialog *self = RULE_SETUP_DIALOG (object);
   RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
 
-  rule_validate_time_finalize (&priv->rule_time_validator);
+  g_cancellable_cancel (priv->cancellable);
+  g_clear_object (&priv->cancellable);
+  g_cancellable_cancel (priv->conflict_cancellable);
+  g_clear_object (&priv->conflict_cancellable);
+
+  g_clear_pointer (&priv->time_index, rule_time_index_unref);
 
   G_OBJECT_CLASS (rule_setup_dialog_parent_class)->dispose (object);
 }
@@ -376,22 +544,11 @@ rule_setup_dialog_class_init (RuleSetupDialogClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, mode_row);
   gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, conflicting_rule_revealer);
   gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, days_row_bin);
-  gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, conflicting_days_row_bin);
-  gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, conflicting_rule_title);
-  gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, conflicting_rule_time);
+  gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, warn_label);
+  gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, conflicting_rules_list);
   gtk_widget_class_bind_template_child_private (widget_class, RuleSetupDialog, time_chooser);
 
   // Properties
-  /* Pass an id != 0 to set the rule values in the dialog (for editing the rule) */
-  obj_properties[PROP_ID] =
-    g_param_spec_int ("id",
-                      NULL, NULL,
-                      0, UINT16_MAX,
-                      0,
-                      G_PARAM_CONSTRUCT_ONLY |
-                      G_PARAM_WRITABLE |
-                      G_PARAM_STATIC_NAME);
-
   obj_properties[PROP_TABLE] =
     g_param_spec_int ("table",
                       NULL, NULL,
@@ -459,7 +616,6 @@ rule_setup_dialog_init (RuleSetupDialog *self)
 {
   RuleSetupDialogPrivate *priv = rule_setup_dialog_get_instance_private (self);
   DaysRow *days_row = NULL;
-  DaysRow *conflicting_days_row = NULL;
 
   // Esure my custom widgets types
   g_type_ensure (TIME_TYPE_CHOOSER);
@@ -467,16 +623,15 @@ rule_setup_dialog_init (RuleSetupDialog *self)
 
   gtk_widget_init_template (GTK_WIDGET (self));
 
+  // The dialog is reused, see rule_setup_dialog_set_rule()
+  gtk_window_set_hide_on_close (GTK_WINDOW (self), TRUE);
+
   // Widgets
   days_row = days_row_new (TRUE);
-  conflicting_days_row = days_row_new (FALSE);
 
   adw_bin_set_child (priv->days_row_bin,
                      GTK_WIDGET (days_row));
 
-  adw_bin_set_child (priv->conflicting_days_row_bin,
-                     GTK_WIDGET (conflicting_days_row));
-
   // Signals
   g_signal_connect (priv->cancel_button,
                     "clicked",
@@ -503,7 +658,10 @@ rule_setup_dialog_init (RuleSetupDialog *self)
   priv->table = TABLE_LAST;
   priv->active = TRUE;
   priv->mode = MODE_LAST;
-  priv->rule_time_validator = NULL;
+  priv->time_index = NULL;
+  priv->cancellable = g_cancellable_new ();
+  priv->conflict_cancellable = NULL;
+  priv->conflict_window = DEFAULT_CONFLICT_WINDOW;
 
   mode_row_set_mode (priv->mode_row, (guint) MODE_OFF);
 }
@@ -26,6 +26,8 @@
 #include "database-connection/database-connection.h"
 #undef ALLOW_MANAGING_RULES
 
+#include "rule-time-index.h"
+
 G_BEGIN_DECLS
 
 #define RULE_TYPE_SETUP_DIALOG (rule_setup_dialog_get_type ())
@@ -38,11 +40,15 @@ struct _RuleSetupDialogClass
   AdwWindowClass parent_class;
 
   // METHODS
-  /* Action to be performed by the dialog, when the user enters the data */
-  guint16 (*perform_action) (Rule *rule);
+  /* Action to be performed by the dialog, when the user enters the data;
+   * it runs on the database worker thread (see database-async.h)
+   */
+  guint32 (*perform_action) (Rule *rule);
 };
 
 RuleSetupDialog *rule_setup_dialog_new (void);
 void rule_setup_dialog_finish (RuleSetupDialog *self);
+void rule_setup_dialog_set_time_index (RuleSetupDialog *self, RuleTimeIndex *time_index);
+void rule_setup_dialog_set_rule (RuleSetupDialog *self, const Rule *rule);
 
 G_END_DECLS
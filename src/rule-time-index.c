@@ -0,0 +1,393 @@
+/* rule-time-index.c
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/*
+ * In-memory index of the rules of a table, used to detect conflicting times.
+ *
+ * Each minute of the week is a slot, holding the ids of the rules that fire
+ * on it, so checking a time is at most one lookup per day: it doesn't depend
+ * on the number of rules. The index is kept up to date by its owner, as the
+ * rules are added, edited or deleted.
+ *
+ * The index keeps a copy of each rule, so a lookup returns the conflicting
+ * rules themselves, and it is guarded by a lock, so lookups can also run on a
+ * worker thread (see rule_time_index_lookup_async ()).
+ *
+ * There's one index per table, shared by its face and the setup dialogs of
+ * both tables, as rules are also checked against the other table.
+ */
+
+#include <string.h>
+
+#include "rule-time-index.h"
+
+struct _RuleTimeIndex
+{
+  gatomicrefcount       ref_count;
+  GMutex                lock;
+
+  /* Ids of the rules on each slot; NULL if none */
+  GArray               *slots[RULE_TIME_INDEX_SLOTS];
+
+  /* Days with any rule on each minute of the day, so most lookups are a single AND */
+  RuleDays              occupied[24 * 60];
+
+  /* Indexed rules: id -> Rule */
+  GHashTable           *rules;
+};
+
+typedef struct
+{
+  RuleTimeIndex        *index;
+  RuleTimeIndex        *other;
+  guint32               exclude_id;
+  guint8                hour;
+  guint8                minutes;
+  RuleDays              days;
+  guint                 window;
+} LookupTaskData;
+
+static inline guint
+rule_time_index_slot (guint day,
+                      guint minute_of_day)
+{
+  return day * (24 * 60) + minute_of_day;
+}
+
+static void
+rule_time_index_slot_remove (RuleTimeIndex *self,
+                             guint          slot,
+                             guint32        rule_id)
+{
+  GArray *ids = self->slots[slot];
+
+  if (ids == NULL)
+    return;
+
+  for (guint i = 0; i < ids->len; i++)
+    {
+      if (g_array_index (ids, guint32, i) == rule_id)
+        {
+          g_array_remove_index_fast (ids, i);
+          break;
+        }
+    }
+
+  if (ids->len == 0)
+    g_clear_pointer (&self->slots[slot], g_array_unref);
+}
+
+// Must be called with the lock held
+static void
+rule_time_index_remove_locked (RuleTimeIndex *self,
+                               guint32        rule_id)
+{
+  gpointer value = NULL;
+  g_autofree Rule *rule = NULL;
+  guint minute_of_day;
+  RuleDays days;
+
+  if (!g_hash_table_steal_extended (self->rules, GUINT_TO_POINTER (rule_id), NULL, &value))
+    return;
+
+  rule = value;
+  minute_of_day = rule->hour * 60 + rule->minutes;
+  days = rule_days_from_array (rule->days);
+
+  for (guint day = 0; day < 7; day++)
+    {
+      guint slot = rule_time_index_slot (day, minute_of_day);
+
+      if (!rule_days_has (days, day))
+        continue;
+
+      rule_time_index_slot_remove (self, slot, rule_id);
+      if (self->slots[slot] == NULL)
+        self->occupied[minute_of_day] &= ~RULE_DAYS_DAY (day);
+    }
+}
+
+void
+rule_time_index_remove (RuleTimeIndex *self,
+                        guint32        rule_id)
+{
+  g_mutex_lock (&self->lock);
+  rule_time_index_remove_locked (self, rule_id);
+  g_mutex_unlock (&self->lock);
+}
+
+// Adding an already indexed rule updates it
+void
+rule_time_index_add (RuleTimeIndex *self,
+                     const Rule    *rule)
+{
+  guint minute_of_day = rule->hour * 60 + rule->minutes;
+  RuleDays days = rule_days_from_array (rule->days);
+
+  g_return_if_fail (minute_of_day < 24 * 60);
+
+  g_mutex_lock (&self->lock);
+
+  rule_time_index_remove_locked (self, rule->id);
+
+  for (guint day = 0; day < 7; day++)
+    {
+      guint slot;
+
+      if (!rule_days_has (days, day))
+        continue;
+
+      slot = rule_time_index_slot (day, minute_of_day);
+
+      if (self->slots[slot] == NULL)
+        self->slots[slot] = g_array_sized_new (FALSE, FALSE, sizeof (guint32), 1);
+
+      g_array_append_val (self->slots[slot], rule->id);
+    }
+
+  self->occupied[minute_of_day] |= days;
+
+  g_hash_table_insert (self->rules,
+                       GUINT_TO_POINTER (rule->id),
+                       g_memdup2 (rule, sizeof (Rule)));
+
+  g_mutex_unlock (&self->lock);
+}
+
+void
+rule_time_index_clear (RuleTimeIndex *self)
+{
+  g_mutex_lock (&self->lock);
+
+  for (guint slot = 0; slot < RULE_TIME_INDEX_SLOTS; slot++)
+    g_clear_pointer (&self->slots[slot], g_array_unref);
+
+  memset (self->occupied, 0, sizeof (self->occupied));
+  g_hash_table_remove_all (self->rules);
+
+  g_mutex_unlock (&self->lock);
+}
+
+/*
+ * Appends to <conflicts> every rule firing within <window> minutes of the time,
+ * on any of the <days>, except <exclude_id>. The window may cross midnight,
+ * into the previous or the next day.
+ */
+void
+rule_time_index_collect (RuleTimeIndex *self,
+                         guint32        exclude_id,
+                         guint8         hour,
+                         guint8         minutes,
+                         RuleDays       days,
+                         guint          window,
+                         GArray        *conflicts)
+{
+  const gint week = RULE_TIME_INDEX_SLOTS;
+  guint minute_of_day = hour * 60 + minutes;
+  g_autoptr (GHashTable) seen = NULL;
+
+  g_return_if_fail (self != NULL);
+
+  if (minute_of_day >= 24 * 60 || days == RULE_DAYS_NONE)
+    return;
+
+  window = MIN (window, 12 * 60);
+
+  // A rule repeating on several days shows up once
+  seen = g_hash_table_new (NULL, NULL);
+
+  g_mutex_lock (&self->lock);
+
+  for (guint day = 0; day < 7; day++)
+    {
+      if (!rule_days_has (days, day))
+        continue;
+
+      for (gint offset = -(gint) window; offset <= (gint) window; offset++)
+        {
+          guint slot = (guint) (((gint) rule_time_index_slot (day, minute_of_day) + offset + week) % week);
+          GArray *ids = NULL;
+
+          // Checks the day bit of that minute first
+          if (!rule_days_has (self->occupied[slot % (24 * 60)], slot / (24 * 60)))
+            continue;
+
+          ids = self->slots[slot];
+          for (guint i = 0; i < ids->len; i++)
+            {
+              guint32 id = g_array_index (ids, guint32, i);
+
+              if (id == exclude_id || !g_hash_table_add (seen, GUINT_TO_POINTER (id)))
+                continue;
+
+              g_array_append_val (conflicts,
+                                  *(Rule *) g_hash_table_lookup (self->rules, GUINT_TO_POINTER (id)));
+            }
+        }
+    }
+
+  g_mutex_unlock (&self->lock);
+}
+
+// ASYNC LOOKUP
+static void
+lookup_task_data_free (gpointer data)
+{
+  LookupTaskData *lookup_task_data = data;
+
+  rule_time_index_unref (lookup_task_data->index);
+  g_clear_pointer (&lookup_task_data->other, rule_time_index_unref);
+  g_free (lookup_task_data);
+}
+
+static void
+rule_time_index_lookup_thread (GTask        *task,
+                               gpointer      source_object,
+                               gpointer      task_data,
+                               GCancellable *cancellable)
+{
+  LookupTaskData *data = task_data;
+  GArray *conflicts = NULL;
+
+  // Superseded before it started
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  conflicts = g_array_new (FALSE, FALSE, sizeof (Rule));
+
+  // Same table: the same minute
+  rule_time_index_collect (data->index,
+                           data->exclude_id,
+                           data->hour,
+                           data->minutes,
+                           data->days,
+                           0,
+                           conflicts);
+
+  // Other table: anything within the window; the ids are from another table
+  if (data->other != NULL)
+    rule_time_index_collect (data->other,
+                             0,
+                             data->hour,
+                             data->minutes,
+                             data->days,
+                             data->window,
+                             conflicts);
+
+  g_task_return_pointer (task, conflicts, (GDestroyNotify) g_array_unref);
+}
+
+/*
+ * Collects, on a worker thread, the rules of <self> at the same time, and the
+ * rules of <other> (the opposite table; may be NULL) within <window> minutes.
+ * Cancel <cancellable> to supersede it: a cancelled lookup always finishes
+ * with G_IO_ERROR_CANCELLED, even if it already ran.
+ */
+void
+rule_time_index_lookup_async (RuleTimeIndex       *self,
+                              RuleTimeIndex       *other,
+                              gpointer             source_object,
+                              guint32              exclude_id,
+                              guint8               hour,
+                              guint8               minutes,
+                              RuleDays             days,
+                              guint                window,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  LookupTaskData *data = g_new0 (LookupTaskData, 1);
+
+  data->index = rule_time_index_ref (self);
+  data->other = (other != NULL) ? rule_time_index_ref (other) : NULL;
+  data->exclude_id = exclude_id;
+  data->hour = hour;
+  data->minutes = minutes;
+  data->days = days;
+  data->window = window;
+
+  task = g_task_new (source_object, cancellable, callback, user_data);
+  g_task_set_source_tag (task, rule_time_index_lookup_async);
+  g_task_set_task_data (task, data, lookup_task_data_free);
+  g_task_set_return_on_cancel (task, TRUE);
+  g_task_run_in_thread (task, rule_time_index_lookup_thread);
+}
+
+// Returns the conflicting rules (GArray of Rule, possibly empty); NULL on error
+GArray *
+rule_time_index_lookup_finish (GAsyncResult  *result,
+                               GError       **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+RuleTimeIndex *
+rule_time_index_ref (RuleTimeIndex *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  g_atomic_ref_count_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+rule_time_index_unref (RuleTimeIndex *self)
+{
+  g_return_if_fail (self != NULL);
+
+  if (!g_atomic_ref_count_dec (&self->ref_count))
+    return;
+
+  rule_time_index_clear (self);
+  g_hash_table_unref (self->rules);
+  g_mutex_clear (&self->lock);
+  g_free (self);
+}
+
+/*
+ * The shared index of <table>; it lives as long as the process, so its owner
+ * (the table's face) clears it before each full load
+ */
+RuleTimeIndex *
+rule_time_index_get_default (Table table)
+{
+  static RuleTimeIndex *indexes[TABLE_LAST] = { NULL };
+
+  g_return_val_if_fail (table < TABLE_LAST, NULL);
+
+  if (indexes[table] == NULL)
+    indexes[table] = rule_time_index_new ();
+
+  return indexes[table];
+}
+
+RuleTimeIndex *
+rule_time_index_new (void)
+{
+  RuleTimeIndex *self = g_new0 (RuleTimeIndex, 1);
+
+  g_atomic_ref_count_init (&self->ref_count);
+  g_mutex_init (&self->lock);
+  self->rules = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  return self;
+}
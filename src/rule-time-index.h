@@ -0,0 +1,71 @@
+/* rule-time-index.h
+ *
+ * Copyright 2025 Kelvin Novais
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#define ALLOW_MANAGING_RULES
+#include "database-connection/database-connection.h"
+#undef ALLOW_MANAGING_RULES
+
+#include "rule-days.h"
+
+G_BEGIN_DECLS
+
+// One slot per minute of the week: 7 days * 24 hours * 60 minutes
+#define RULE_TIME_INDEX_SLOTS (7 * 24 * 60)
+
+typedef struct _RuleTimeIndex RuleTimeIndex;
+
+RuleTimeIndex *rule_time_index_new (void);
+RuleTimeIndex *rule_time_index_get_default (Table table);
+RuleTimeIndex *rule_time_index_ref (RuleTimeIndex *self);
+void rule_time_index_unref (RuleTimeIndex *self);
+
+void rule_time_index_add (RuleTimeIndex *self, const Rule *rule);
+void rule_time_index_remove (RuleTimeIndex *self, guint32 rule_id);
+void rule_time_index_clear (RuleTimeIndex *self);
+
+void rule_time_index_collect (RuleTimeIndex *self,
+                              guint32        exclude_id,
+                              guint8         hour,
+                              guint8         minutes,
+                              RuleDays       days,
+                              guint          window,
+                              GArray        *conflicts);
+
+void rule_time_index_lookup_async (RuleTimeIndex       *self,
+                                   RuleTimeIndex       *other,
+                                   gpointer             source_object,
+                                   guint32              exclude_id,
+                                   guint8               hour,
+                                   guint8               minutes,
+                                   RuleDays             days,
+                                   guint                window,
+                                   GCancellable        *cancellable,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data);
+GArray *rule_time_index_lookup_finish (GAsyncResult  *result,
+                                       GError       **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (RuleTimeIndex, rule_time_index_unref)
+
+G_END_DECLS
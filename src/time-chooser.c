@@ -23,6 +23,7 @@
 #include "database-connection/database-connection.h"
 
 #include "time-chooser.h"
+#include "gawake-clock-format.h"
 
 struct _TimeChooser
 {
@@ -36,6 +37,10 @@ struct _TimeChooser
 
   // Instance variables
   Period                 period;
+  gboolean               twelve_hour;     // follows GawakeClockFormat
+  guint8                 emitted_hour24;  // last values notified
+  guint8                 emitted_minutes;
+  guint                  tick_id;
 };
 
 // Translations
@@ -68,6 +73,37 @@ time_chooser_emit_value_updated (TimeChooser *self)
                  0);
 }
 
+// Emits "value-updated" at most once per frame, and only on actual changes
+static gboolean
+time_chooser_value_updated_tick (GtkWidget     *widget,
+                                 GdkFrameClock *frame_clock,
+                                 gpointer       user_data)
+{
+  TimeChooser *self = TIME_CHOOSER (widget);
+  guint8 hour24 = time_chooser_get_hour24 (self);
+  guint8 minutes = time_chooser_get_minutes (self);
+
+  self->tick_id = 0;
+
+  if (hour24 != self->emitted_hour24 || minutes != self->emitted_minutes)
+    {
+      self->emitted_hour24 = hour24;
+      self->emitted_minutes = minutes;
+      time_chooser_emit_value_updated (self);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+time_chooser_queue_value_updated (TimeChooser *self)
+{
+  if (self->tick_id == 0)
+    self->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                  time_chooser_value_updated_tick,
+                                                  NULL, NULL);
+}
+
 static void
 time_chooser_set_am_pm_label (TimeChooser *self, Period period)
 {
@@ -81,7 +117,7 @@ time_chooser_set_hour24 (TimeChooser *self, gdouble hour24)
   guint8 hour = (guint8) hour24;
   Period period;
 
-  if (time_converter_get_format () == TIME_FORMAT_TWELVE)
+  if (self->twelve_hour)
     {
       time_converter_to_twelve_format (hour24, &hour, &period);
       time_chooser_set_am_pm_label (self, period);
@@ -102,7 +138,7 @@ time_chooser_get_hour24 (TimeChooser *self)
   gdouble _hour = gtk_spin_button_get_value (self->h_spinbutton);
   guint8 hour = 0;
 
-  if (time_converter_get_format () == TIME_FORMAT_TWELVE)
+  if (self->twelve_hour)
     time_converter_to_twentyfour_format (_hour, &hour, self->period);
   else
     hour = (guint8) _hour;
@@ -120,21 +156,24 @@ static gboolean
 time_chooser_show_leading_zeros (GtkSpinButton *spin,
                                  gpointer       data)
 {
-  TimeChooser *self = TIME_CHOOSER (data);
-  gchar *text;
-  gint value;
-
-  value = gtk_spin_button_get_value_as_int (spin);
-  text = g_strdup_printf ("%02d", value);
-  gtk_editable_set_text (GTK_EDITABLE (spin), text);
-  g_free (text);
+  gchar text[4];
 
-  // Notify changes
-  time_chooser_emit_value_updated (self);
+  // Called on every redraw too, so don't allocate nor notify anything here
+  g_snprintf (text, sizeof (text), "%02d", gtk_spin_button_get_value_as_int (spin));
+  if (g_strcmp0 (text, gtk_editable_get_text (GTK_EDITABLE (spin))) != 0)
+    gtk_editable_set_text (GTK_EDITABLE (spin), text);
 
   return TRUE;
 }
 
+static void
+time_chooser_spin_button_value_changed (GtkSpinButton *spin,
+                                        gpointer       user_data)
+{
+  // Notify changes
+  time_chooser_queue_value_updated (TIME_CHOOSER (user_data));
+}
+
 static void
 time_chooser_am_pm_invert_label (GtkButton *button,
                                  gpointer   user_data)
@@ -143,12 +182,51 @@ time_chooser_am_pm_invert_label (GtkButton *button,
   time_chooser_set_am_pm_label (self, !self->period);
 
   // Notify changes
-  time_chooser_emit_value_updated (self);
+  time_chooser_queue_value_updated (self);
+}
+
+static void
+time_chooser_set_twelve_hour (TimeChooser *self,
+                              gboolean     twelve_hour)
+{
+  // Keep showing the same time on the new format
+  guint8 hour24 = time_chooser_get_hour24 (self);
+
+  self->twelve_hour = twelve_hour;
+
+  if (twelve_hour)
+    // Limit the hour spinbutton to 12 hours format
+    gtk_spin_button_set_range (self->h_spinbutton, 1, 12);
+  else
+    // Limit the hour spinbutton to 24 hours
+    gtk_spin_button_set_range (self->h_spinbutton, 0, 23);
+
+  // The AM/PM button is only visible on 12 hours format
+  gtk_widget_set_visible (GTK_WIDGET (self->am_pm_bin), twelve_hour);
+
+  time_chooser_set_hour24 (self, (gdouble) hour24);
+}
+
+static void
+time_chooser_clock_format_changed (GObject    *object,
+                                   GParamSpec *pspec,
+                                   gpointer    user_data)
+{
+  time_chooser_set_twelve_hour (TIME_CHOOSER (user_data),
+                                gawake_clock_format_get_twelve_hour (GAWAKE_CLOCK_FORMAT (object)));
 }
 
 static void
 time_chooser_dispose (GObject *gobject)
 {
+  TimeChooser *self = TIME_CHOOSER (gobject);
+
+  if (self->tick_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->tick_id);
+      self->tick_id = 0;
+    }
+
   gtk_widget_dispose_template (GTK_WIDGET (gobject), TIME_TYPE_CHOOSER);
 
   G_OBJECT_CLASS (time_chooser_parent_class)->dispose (gobject);
@@ -199,40 +277,51 @@ time_chooser_init (TimeChooser *self)
                     G_CALLBACK (time_chooser_show_leading_zeros),
                     self);
 
+  g_signal_connect (self->h_spinbutton,
+                    "value-changed",
+                    G_CALLBACK (time_chooser_spin_button_value_changed),
+                    self);
+
+  g_signal_connect (self->m_spinbutton,
+                    "value-changed",
+                    G_CALLBACK (time_chooser_spin_button_value_changed),
+                    self);
+
   g_signal_connect (self->am_pm_button,
                     "clicked",
                     G_CALLBACK (time_chooser_am_pm_invert_label),
                     self);
 
+  g_signal_connect_object (gawake_clock_format_get_default (),
+                           "notify::twelve-hour",
+                           G_CALLBACK (time_chooser_clock_format_changed),
+                           self,
+                           0);
+
   // Set current time*
   now = g_date_time_new_now_local ();
+  self->period = PERIOD_AM;
+  self->tick_id = 0;
+  self->twelve_hour = gawake_clock_format_get_twelve_hour (gawake_clock_format_get_default ());
 
-  if (time_converter_get_format () == TIME_FORMAT_TWELVE)
+  if (self->twelve_hour)
     {
-      g_autofree gchar *formatted_time = NULL;
-
-      // Limit the hour spinbutton to 12 hours format
       gtk_spin_button_set_range (self->h_spinbutton, 1, 12);
-
-      // Make the button visible
       gtk_widget_set_visible (GTK_WIDGET (self->am_pm_bin), TRUE);
-
-      // TimeChooser defaults to current time*, so set the proper AM/PM label
-      formatted_time = g_date_time_format (now, "%I:%M %p");
-      if (strstr (formatted_time, "AM"))
-        time_chooser_set_am_pm_label (self, PERIOD_AM);
-      else
-        time_chooser_set_am_pm_label (self, PERIOD_PM);
     }
   else
     {
-      // Limit the hour spinbutton to 24 hours
       gtk_spin_button_set_range (self->h_spinbutton, 0, 23);
     }
 
+  // Also sets the AM/PM label, on 12 hours format
   time_chooser_set_hour24 (self, (gdouble) g_date_time_get_hour (now));
   time_chooser_set_minutes (self, (gdouble) g_date_time_get_minute (now));
 
+  // The initial time isn't a change
+  self->emitted_hour24 = time_chooser_get_hour24 (self);
+  self->emitted_minutes = time_chooser_get_minutes (self);
+
   g_debug ("TimeChooser now [HH:MM]: %02d:%02d",
            g_date_time_get_hour (now),
            g_date_time_get_minute (now));